@@ -0,0 +1,46 @@
+#ifndef ALERT_CATALOG_H
+#define ALERT_CATALOG_H
+
+#include <Arduino.h>
+
+// 预警音效编号，同时作为 ALERT_CATALOG、音效索引缓存与配置时长数组的下标
+enum AlertId : uint8_t {
+    ALERT_NORMAL,
+    ALERT_DANGER,
+    ALERT_LEFT,
+    ALERT_RIGHT,
+    ALERT_REAR,
+    ALERT_START,
+    ALERT_COUNT,
+    ALERT_NONE = 0xFF
+};
+
+struct AlertInfo {
+    const char *type;           // 网页测试与上传使用的类型名
+    const char *path;           // 音效文件路径：LittleFS 中有同名文件时播放该文件，否则播放内置资源镜像中的音效
+    const char *durationKey;    // 配置 JSON 中的实际时长字段
+    uint16_t defaultDurationMs; // 未上传音效时的最大播放时长
+    uint8_t priority;           // 数值大的可打断正在播放的低优先级音效
+};
+
+// 新增音效只需在此追加一行，并在 AlertId 中增加对应编号
+constexpr AlertInfo ALERT_CATALOG[ALERT_COUNT] = {
+    {"normal", "/normal.mp3", "audioDurationMsNormal", 2000, 1},
+    {"danger", "/danger.mp3", "audioDurationMsDanger", 1000, 3},
+    {"left", "/left.mp3", "audioDurationMsLeft", 1000, 2},
+    {"right", "/right.mp3", "audioDurationMsRight", 1000, 2},
+    {"rear", "/rear.mp3", "audioDurationMsRear", 1000, 2},
+    {"start", "/start.mp3", "audioDurationMsStart", 1000, 0},
+};
+
+// 按类型名查找（不区分大小写），仅用于网页请求等非预警路径
+inline AlertId alertFromType(const char *type) {
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        if (strcasecmp(type, ALERT_CATALOG[i].type) == 0) {
+            return (AlertId) i;
+        }
+    }
+    return ALERT_NONE;
+}
+
+#endif // ALERT_CATALOG_H
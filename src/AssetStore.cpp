@@ -0,0 +1,221 @@
+#include "AssetStore.h"
+#include <LittleFS.h>
+
+#ifdef RADAR_ASSET_BLOB
+// 由 tools/pack_assets.py 在编译前生成，定义 ASSET_BLOB 与 ASSET_BLOB_SIZE
+#include "AssetBlob.h"
+#else
+// 未打包资源时（如仅灯光的编译配置）为只有头部的空镜像
+static const uint8_t ASSET_BLOB[8] PROGMEM __attribute__((aligned(4))) = {0x52, 0x41, 0x42, 0x31, 0, 0, 0, 0};
+#define ASSET_BLOB_SIZE 8
+#endif
+
+#define ASSET_HEADER_SIZE 8
+
+AssetStore::AssetStore() {
+    memset(entries, 0, sizeof(entries));
+    count = 0;
+    overridden = 0;
+    uploaded = 0;
+}
+
+void AssetStore::begin() {
+    count = 0;
+    uint32_t header[2];
+    memcpy_P(header, ASSET_BLOB, sizeof(header));
+    if (header[0] != ASSET_MAGIC || header[1] > ASSET_MAX) {
+        return;
+    }
+    memcpy_P(entries, ASSET_BLOB + ASSET_HEADER_SIZE, header[1] * sizeof(AssetEntry));
+    for (uint8_t i = 0; i < header[1]; i++) {
+        AssetEntry &e = entries[i];
+        e.name[ASSET_NAME_LEN - 1] = '\0';
+        if (e.offset > ASSET_BLOB_SIZE || e.size > ASSET_BLOB_SIZE - e.offset) {
+            break;
+        }
+        count = i + 1;
+    }
+    loadUploaded();
+    removeLegacyFiles();
+    refresh();
+}
+
+int8_t AssetStore::indexOf(const char *path) const {
+    for (uint8_t i = 0; i < count; i++) {
+        if (strcmp(path, entries[i].name) == 0) {
+            return (int8_t) i;
+        }
+    }
+    return -1;
+}
+
+void AssetStore::loadUploaded() {
+    uploaded = 0;
+    File f = LittleFS.open(ASSET_USER_PATH, "r");
+    if (!f) {
+        return;
+    }
+    char line[ASSET_NAME_LEN + 2];
+    while (f.available()) {
+        const size_t n = f.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[n] = '\0';
+        const int8_t index = indexOf(line);
+        if (index >= 0) {
+            uploaded |= 1 << index;
+        }
+    }
+    f.close();
+}
+
+bool AssetStore::saveUploaded() const {
+    File f = LittleFS.open(ASSET_USER_PATH, "w");
+    if (!f) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if ((uploaded >> i) & 1) {
+            f.print(entries[i].name);
+            f.print('\n');
+        }
+    }
+    f.close();
+    return true;
+}
+
+void AssetStore::removeLegacyFiles() {
+    for (uint8_t i = 0; i < count; i++) {
+        const char *name = entries[i].name;
+        if (((uploaded >> i) & 1) || !LittleFS.exists(name)) {
+            continue;
+        }
+        LittleFS.remove(name);
+        // 帧索引旁路文件，命名与 Mp3Scanner::indexPathFor 一致
+        LittleFS.remove(String(name) + ".idx");
+    }
+}
+
+void AssetStore::markUploaded(const char *path) {
+    const int8_t index = indexOf(path);
+    if (index < 0 || ((uploaded >> index) & 1)) {
+        return;
+    }
+    uploaded |= 1 << index;
+    saveUploaded();
+}
+
+void AssetStore::refresh() {
+    overridden = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (((uploaded >> i) & 1) && LittleFS.exists(entries[i].name)) {
+            overridden |= 1 << i;
+        }
+    }
+}
+
+int8_t AssetStore::find(const char *path) const {
+    const int8_t index = indexOf(path);
+    return index >= 0 && isOverridden(index) ? -1 : index;
+}
+
+uint8_t AssetStore::getCount() const {
+    return count;
+}
+
+const AssetEntry &AssetStore::get(uint8_t index) const {
+    return entries[index];
+}
+
+bool AssetStore::isOverridden(uint8_t index) const {
+    return (overridden >> index) & 1;
+}
+
+const uint8_t *AssetStore::data(uint8_t index) const {
+    return ASSET_BLOB + entries[index].offset;
+}
+
+uint32_t AssetStore::read(uint8_t index, uint32_t pos, void *buf, uint32_t len) const {
+    const AssetEntry &e = entries[index];
+    if (pos >= e.size) {
+        return 0;
+    }
+    if (len > e.size - pos) {
+        len = e.size - pos;
+    }
+    // 闪存只能按 4 字节对齐访问，memcpy_P 处理任意偏移
+    memcpy_P(buf, ASSET_BLOB + e.offset + pos, len);
+    return len;
+}
+
+void AssetStore::benchmark(uint8_t index, AssetBench &result) const {
+    memset(&result, 0, sizeof(result));
+    const AssetEntry &e = entries[index];
+    uint8_t buf[512];
+    // 闪存：按路径查索引即为打开，随后按与音频解码相同的块大小读完
+    uint32_t start = micros();
+    int8_t found = -1;
+    for (uint8_t i = 0; i < count && found < 0; i++) {
+        if (strcmp(e.name, entries[i].name) == 0) {
+            found = (int8_t) i;
+        }
+    }
+    result.flashOpenUs = micros() - start;
+    start = micros();
+    for (uint32_t pos = 0; pos < e.size; pos += sizeof(buf)) {
+        read(index, pos, buf, sizeof(buf));
+    }
+    result.flashReadUs = micros() - start;
+
+    // 把同一资源写成 LittleFS 临时文件（不计时），剩余空间不足时只报告闪存结果
+    File tmp = LittleFS.open(ASSET_BENCH_PATH, "w");
+    if (!tmp) {
+        return;
+    }
+    uint32_t written = 0;
+    for (uint32_t pos = 0; pos < e.size; pos += sizeof(buf)) {
+        const uint32_t n = read(index, pos, buf, sizeof(buf));
+        if (tmp.write(buf, n) != n) {
+            break;
+        }
+        written += n;
+        yield();
+    }
+    tmp.close();
+    if (written == e.size) {
+        start = micros();
+        File f = LittleFS.open(ASSET_BENCH_PATH, "r");
+        result.fsOpenUs = micros() - start;
+        if (f) {
+            result.fsCopied = true;
+            start = micros();
+            while (f.read(buf, sizeof(buf)) > 0) {
+            }
+            f.close();
+            result.fsReadUs = micros() - start;
+        } else {
+            result.fsOpenUs = 0;
+        }
+    }
+    LittleFS.remove(ASSET_BENCH_PATH);
+}
+
+void AssetStore::writeJson(Print &out) const {
+    out.print("{\"blobBytes\":");
+    out.print((unsigned long) ASSET_BLOB_SIZE);
+    out.print(",\"assets\":[");
+    for (uint8_t i = 0; i < count; i++) {
+        const AssetEntry &e = entries[i];
+        if (i > 0) {
+            out.print(',');
+        }
+        out.print("{\"name\":\"");
+        out.print(e.name);
+        out.print("\",\"offset\":");
+        out.print(e.offset);
+        out.print(",\"size\":");
+        out.print(e.size);
+        out.print(",\"overridden\":");
+        out.print(isOverridden(i) ? "true" : "false");
+        out.print('}');
+    }
+    out.print("]}");
+}
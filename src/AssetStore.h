@@ -0,0 +1,85 @@
+#ifndef ASSET_STORE_H
+#define ASSET_STORE_H
+
+#include <Arduino.h>
+
+#define ASSET_MAGIC 0x31424152UL    // "RAB1"
+#define ASSET_NAME_LEN 16           // 含结尾 0 的路径长度，如 "/index.html"
+#define ASSET_MAX 8
+#define ASSET_USER_PATH "/assets.user"  // 网页上传过的资源路径，每行一个
+#define ASSET_BENCH_PATH "/bench.tmp"   // 读取对比时写入的临时副本，测完即删除
+
+// 资源镜像的索引条目，与 tools/pack_assets.py 的打包格式一致
+struct AssetEntry {
+    char name[ASSET_NAME_LEN];
+    uint32_t offset;                // 相对镜像起点，4 字节对齐
+    uint32_t size;
+};
+
+static_assert(sizeof(AssetEntry) == 24, "索引条目须与打包脚本一致");
+
+// 单个资源的读取耗时对比（微秒），用于 POST /assets/bench
+struct AssetBench {
+    uint32_t flashOpenUs;
+    uint32_t flashReadUs;
+    bool fsCopied;                  // LittleFS 临时副本写入成功时才有下面两项
+    uint32_t fsOpenUs;
+    uint32_t fsReadUs;
+};
+
+// 编译进固件的只读资源镜像（网页与内置音效）。
+// 镜像格式：magic、条目数、索引条目，随后各资源数据按 4 字节对齐依次排列；
+// 启动时把索引读入内存，之后按下标直接读取闪存偏移，不经过文件系统。
+// 只有经网页上传（记录在 /assets.user 中）的同名文件才覆盖该条目，由调用方改用文件系统；
+// 旧版本 data/ 文件系统镜像留在 LittleFS 中的同名文件在启动时删除，避免升级后一直盖住新的内置资源
+class AssetStore {
+private:
+    AssetEntry entries[ASSET_MAX];
+    uint8_t count;
+    uint8_t overridden;             // 按下标的位图
+    uint8_t uploaded;               // 用户上传过的条目，按下标的位图
+
+    int8_t indexOf(const char *path) const;
+
+    void loadUploaded();
+
+    bool saveUploaded() const;
+
+    // 删除未记录为用户上传的同名文件及其帧索引
+    void removeLegacyFiles();
+
+public:
+    AssetStore();
+
+    // 读取镜像索引、清理旧版本留下的同名文件并检查 LittleFS 覆盖，须在 LittleFS 挂载后调用
+    void begin();
+
+    // 记录某路径为用户上传，上传替换成功后、refresh 之前调用
+    void markUploaded(const char *path);
+
+    // 重新检查 LittleFS 覆盖，上传或删除文件后调用
+    void refresh();
+
+    // 返回内置资源下标；不存在或已被 LittleFS 覆盖时返回 -1
+    int8_t find(const char *path) const;
+
+    uint8_t getCount() const;
+
+    const AssetEntry &get(uint8_t index) const;
+
+    bool isOverridden(uint8_t index) const;
+
+    // 资源数据在闪存中的地址，只能用 memcpy_P 或 PROGMEM 响应读取
+    const uint8_t *data(uint8_t index) const;
+
+    // 从资源的 pos 处读取最多 len 字节，返回实际读取的字节数
+    uint32_t read(uint8_t index, uint32_t pos, void *buf, uint32_t len) const;
+
+    // 分别从闪存与 LittleFS 打开并完整读取某资源，记录耗时；LittleFS 一侧读取为本次写入的临时副本，
+    // 无需设备上已有同名文件，测完删除
+    void benchmark(uint8_t index, AssetBench &result) const;
+
+    void writeJson(Print &out) const;
+};
+
+#endif // ASSET_STORE_H
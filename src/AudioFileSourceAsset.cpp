@@ -0,0 +1,81 @@
+#include "AudioFileSourceAsset.h"
+
+AudioFileSourceAsset::AudioFileSourceAsset() {
+    store = nullptr;
+    index = -1;
+    pos = 0;
+    clipEnd = 0;
+}
+
+bool AudioFileSourceAsset::open(const AssetStore *assets, uint8_t asset) {
+    if (assets == nullptr || asset >= assets->getCount()) {
+        index = -1;
+        return false;
+    }
+    store = assets;
+    index = (int8_t) asset;
+    pos = 0;
+    clipEnd = store->get(asset).size;
+    return true;
+}
+
+bool AudioFileSourceAsset::open(const char *filename) {
+    (void) filename;
+    return false;
+}
+
+bool AudioFileSourceAsset::setRange(uint32_t start, uint32_t end) {
+    if (index < 0) {
+        return false;
+    }
+    const uint32_t size = store->get(index).size;
+    clipEnd = (end > 0 && end < size) ? end : size;
+    return seek((int32_t) start, SEEK_SET);
+}
+
+uint32_t AudioFileSourceAsset::read(void *data, uint32_t len) {
+    if (index < 0 || pos >= clipEnd) {
+        return 0;
+    }
+    if (len > clipEnd - pos) {
+        len = clipEnd - pos;
+    }
+    const uint32_t n = store->read(index, pos, data, len);
+    pos += n;
+    return n;
+}
+
+bool AudioFileSourceAsset::seek(int32_t offset, int dir) {
+    if (index < 0) {
+        return false;
+    }
+    const int32_t size = (int32_t) store->get(index).size;
+    int32_t target = offset;
+    if (dir == SEEK_CUR) {
+        target += (int32_t) pos;
+    } else if (dir == SEEK_END) {
+        target += size;
+    }
+    if (target < 0 || target > size) {
+        return false;
+    }
+    pos = (uint32_t) target;
+    return true;
+}
+
+bool AudioFileSourceAsset::close() {
+    index = -1;
+    return true;
+}
+
+bool AudioFileSourceAsset::isOpen() {
+    return index >= 0;
+}
+
+uint32_t AudioFileSourceAsset::getSize() {
+    return index >= 0 ? store->get(index).size : 0;
+}
+
+uint32_t AudioFileSourceAsset::getPos() {
+    return pos;
+}
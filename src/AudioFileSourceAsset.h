@@ -0,0 +1,40 @@
+#ifndef AUDIO_FILE_SOURCE_ASSET_H
+#define AUDIO_FILE_SOURCE_ASSET_H
+
+#include <Arduino.h>
+#include <AudioFileSource.h>
+#include "AssetStore.h"
+
+// 从固件内置资源镜像读取的音频源：打开只是记录闪存偏移，读取直接 memcpy_P，
+// 与 AudioFileSourceClip 一样支持只读取 [start, end) 区间
+class AudioFileSourceAsset : public AudioFileSource {
+private:
+    const AssetStore *store;
+    int8_t index;       // -1 表示未打开
+    uint32_t pos;
+    uint32_t clipEnd;   // 读取上限，打开时为资源大小
+
+public:
+    AudioFileSourceAsset();
+
+    bool open(const AssetStore *assets, uint8_t asset);
+
+    // 只支持按资源下标打开，此接口总是失败
+    bool open(const char *filename) override;
+
+    bool setRange(uint32_t start, uint32_t end);
+
+    uint32_t read(void *data, uint32_t len) override;
+
+    bool seek(int32_t offset, int dir) override;
+
+    bool close() override;
+
+    bool isOpen() override;
+
+    uint32_t getSize() override;
+
+    uint32_t getPos() override;
+};
+
+#endif // AUDIO_FILE_SOURCE_ASSET_H
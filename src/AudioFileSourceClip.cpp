@@ -0,0 +1,32 @@
+#include "AudioFileSourceClip.h"
+
+AudioFileSourceClip::AudioFileSourceClip() {
+    clipEnd = 0;
+}
+
+AudioFileSourceClip::AudioFileSourceClip(const char *filename) : AudioFileSourceLittleFS(filename) {
+    clipEnd = 0;
+}
+
+bool AudioFileSourceClip::open(const char *filename) {
+    clipEnd = 0;
+    return AudioFileSourceLittleFS::open(filename);
+}
+
+bool AudioFileSourceClip::setRange(uint32_t start, uint32_t end) {
+    clipEnd = end;
+    return start == 0 || seek((int32_t) start, SEEK_SET);
+}
+
+uint32_t AudioFileSourceClip::read(void *data, uint32_t len) {
+    if (clipEnd > 0) {
+        const uint32_t pos = getPos();
+        if (pos >= clipEnd) {
+            return 0;
+        }
+        if (len > clipEnd - pos) {
+            len = clipEnd - pos;
+        }
+    }
+    return AudioFileSourceLittleFS::read(data, len);
+}
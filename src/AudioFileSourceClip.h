@@ -0,0 +1,25 @@
+#ifndef AUDIO_FILE_SOURCE_CLIP_H
+#define AUDIO_FILE_SOURCE_CLIP_H
+
+#include <Arduino.h>
+#include <AudioFileSourceLittleFS.h>
+
+// 只读取 [start, end) 区间的 LittleFS 音频源：配合上传时生成的帧索引跳过 ID3 标签，
+// 并在末帧之后直接返回 EOF，解码器据此精确结束
+class AudioFileSourceClip : public AudioFileSourceLittleFS {
+private:
+    uint32_t clipEnd; // 0 表示读到文件末尾
+
+public:
+    AudioFileSourceClip();
+
+    AudioFileSourceClip(const char *filename);
+
+    bool open(const char *filename) override;
+
+    bool setRange(uint32_t start, uint32_t end);
+
+    uint32_t read(void *data, uint32_t len) override;
+};
+
+#endif // AUDIO_FILE_SOURCE_CLIP_H
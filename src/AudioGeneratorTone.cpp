@@ -0,0 +1,166 @@
+#include "AudioGeneratorTone.h"
+#include <AudioOutput.h>
+
+// 起止包络长度（采样数），约 1ms，避免方波式的爆音
+static const uint32_t TONE_RAMP_SAMPLES = TONE_SAMPLE_RATE / 1000;
+
+// 四分之一周期正弦表，幅度约为满量程的 1/4，给 SetGain 留出放大余量
+static const int16_t QUARTER_SINE[64] PROGMEM = {
+    101, 301, 502, 703, 903, 1102, 1301, 1499,
+    1696, 1893, 2088, 2281, 2474, 2665, 2854, 3041,
+    3227, 3411, 3593, 3772, 3950, 4124, 4297, 4467,
+    4634, 4798, 4960, 5118, 5274, 5426, 5575, 5720,
+    5863, 6001, 6136, 6267, 6395, 6519, 6638, 6754,
+    6866, 6973, 7077, 7176, 7271, 7361, 7447, 7528,
+    7605, 7678, 7745, 7809, 7867, 7921, 7969, 8013,
+    8053, 8087, 8116, 8141, 8161, 8176, 8185, 8190,
+};
+
+AudioGeneratorTone::AudioGeneratorTone() {
+    running = false;
+    file = nullptr;
+    output = nullptr;
+    lastSample[0] = 0;
+    lastSample[1] = 0;
+    phase = 0;
+    cyclePos = 0;
+    samplesLeft = 0;
+    limited = false;
+    setCadence(1000, 500, 250, false);
+}
+
+AudioGeneratorTone::~AudioGeneratorTone() {
+    if (running) {
+        stop();
+    }
+}
+
+void AudioGeneratorTone::setCadence(uint16_t freqHz, uint16_t periodMs, uint16_t onMs, bool chirpOn) {
+    uint32_t period = (uint32_t) periodMs * TONE_SAMPLE_RATE / 1000UL;
+    if (period == 0) {
+        period = 1;
+    }
+    uint32_t on = (uint32_t) onMs * TONE_SAMPLE_RATE / 1000UL;
+    if (on > period) {
+        on = period;
+    }
+    basePhaseInc = (uint32_t) (((uint64_t) freqHz << 32) / TONE_SAMPLE_RATE);
+    // 扫频：一次鸣响内频率线性升高一半
+    chirpStep = (chirpOn && on > 0) ? (basePhaseInc / 2) / on : 0;
+    chirp = chirpOn;
+    periodSamples = period;
+    onSamples = on;
+    // 播放中修改节奏时保持相位连续，只把越界的周期位置折回
+    if (cyclePos >= periodSamples) {
+        cyclePos = 0;
+    }
+    if (!chirp) {
+        phaseInc = basePhaseInc;
+    }
+}
+
+void AudioGeneratorTone::setDuration(unsigned long ms) {
+    limited = ms > 0;
+    samplesLeft = (uint32_t) ((uint64_t) ms * TONE_SAMPLE_RATE / 1000UL);
+}
+
+int16_t AudioGeneratorTone::nextSample() {
+    if (limited) {
+        if (samplesLeft == 0) {
+            return 0;
+        }
+        samplesLeft--;
+    }
+    int32_t v = 0;
+    if (cyclePos < onSamples) {
+        if (cyclePos == 0) {
+            phaseInc = basePhaseInc;
+        }
+        const uint8_t idx = (uint8_t) (phase >> 24);
+        const uint8_t i = idx & 0x3F;
+        switch (idx >> 6) {
+            case 0: v = (int16_t) pgm_read_word(&QUARTER_SINE[i]);
+                break;
+            case 1: v = (int16_t) pgm_read_word(&QUARTER_SINE[63 - i]);
+                break;
+            case 2: v = -(int16_t) pgm_read_word(&QUARTER_SINE[i]);
+                break;
+            default: v = -(int16_t) pgm_read_word(&QUARTER_SINE[63 - i]);
+                break;
+        }
+        // 间断鸣响时做起止包络；连续音不需要
+        if (onSamples < periodSamples) {
+            const uint32_t fromEnd = onSamples - cyclePos;
+            const uint32_t env = cyclePos < fromEnd ? cyclePos : fromEnd;
+            if (env < TONE_RAMP_SAMPLES) {
+                v = v * (int32_t) env / (int32_t) TONE_RAMP_SAMPLES;
+            }
+        }
+        phase += phaseInc;
+        if (chirp) {
+            phaseInc += chirpStep;
+        }
+    }
+    if (++cyclePos >= periodSamples) {
+        cyclePos = 0;
+    }
+    return (int16_t) v;
+}
+
+bool AudioGeneratorTone::begin(AudioFileSource *source, AudioOutput *output) {
+    if (output == nullptr) {
+        return false;
+    }
+    this->file = source;
+    this->output = output;
+    if (!output->SetRate(TONE_SAMPLE_RATE)) {
+        return false;
+    }
+    if (!output->SetBitsPerSample(16)) {
+        return false;
+    }
+    if (!output->SetChannels(2)) {
+        return false;
+    }
+    if (!output->begin()) {
+        return false;
+    }
+    phase = 0;
+    cyclePos = 0;
+    phaseInc = basePhaseInc;
+    running = true;
+    const int16_t s = nextSample();
+    lastSample[0] = s;
+    lastSample[1] = s;
+    return true;
+}
+
+bool AudioGeneratorTone::loop() {
+    if (!running) {
+        return false;
+    }
+    // 与 MP3 解码器一致：先尝试推送暂存采样，输出缓冲满时返回，下次 loop 再继续
+    while (output->ConsumeSample(lastSample)) {
+        if (limited && samplesLeft == 0) {
+            stop();
+            return false;
+        }
+        const int16_t s = nextSample();
+        lastSample[0] = s;
+        lastSample[1] = s;
+    }
+    output->loop();
+    return running;
+}
+
+bool AudioGeneratorTone::stop() {
+    running = false;
+    if (output != nullptr) {
+        output->stop();
+    }
+    return true;
+}
+
+bool AudioGeneratorTone::isRunning() {
+    return running;
+}
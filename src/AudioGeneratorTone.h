@@ -0,0 +1,47 @@
+#ifndef AUDIO_GENERATOR_TONE_H
+#define AUDIO_GENERATOR_TONE_H
+
+#include <Arduino.h>
+#include <AudioGenerator.h>
+
+#define TONE_SAMPLE_RATE 16000
+
+// 程序化提示音发生器：查表正弦振荡器直接写入 AudioOutput，不读文件、不解码
+// 节奏（周期/鸣响时长）与音高可在播放中随时修改，无需重新开始
+class AudioGeneratorTone : public AudioGenerator {
+private:
+    uint32_t phase;          // 相位累加器，高 8 位为波表索引
+    uint32_t phaseInc;       // 当前每采样相位增量
+    uint32_t basePhaseInc;   // 鸣响起始频率对应的相位增量
+    uint32_t chirpStep;      // 扫频模式下每采样增加的相位增量
+    uint32_t cyclePos;       // 当前周期内的采样位置
+    uint32_t periodSamples;  // 一个“响+停”周期的采样数
+    uint32_t onSamples;      // 每周期鸣响的采样数
+    uint32_t samplesLeft;    // 剩余采样数，0 表示持续播放直到 stop
+    bool limited;
+    bool chirp;
+
+    int16_t nextSample();
+
+public:
+    AudioGeneratorTone();
+
+    ~AudioGeneratorTone() override;
+
+    // source 不使用，可传 nullptr
+    bool begin(AudioFileSource *source, AudioOutput *output) override;
+
+    bool loop() override;
+
+    bool stop() override;
+
+    bool isRunning() override;
+
+    // 设置音高与节奏；onMs >= periodMs 时为连续音，chirpOn 时每次鸣响向上扫频
+    void setCadence(uint16_t freqHz, uint16_t periodMs, uint16_t onMs, bool chirpOn);
+
+    // 限制本次播放总时长（毫秒），0 表示不限
+    void setDuration(unsigned long ms);
+};
+
+#endif // AUDIO_GENERATOR_TONE_H
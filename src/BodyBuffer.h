@@ -0,0 +1,53 @@
+#ifndef BODY_BUFFER_H
+#define BODY_BUFFER_H
+
+#include <Arduino.h>
+
+// 定长请求体缓冲：body 回调按 index 直接写入预分配的数组，不在堆上分配；
+// 声明长度或实际数据超出容量时只做标记，之后的数据全部丢弃
+template<size_t N>
+class BodyBuffer {
+private:
+    char buffer[N];
+    size_t len;
+    bool tooLarge;
+
+public:
+    BodyBuffer() {
+        reset(0);
+    }
+
+    // 新请求开始，total 为请求头声明的长度
+    void reset(size_t total) {
+        len = 0;
+        tooLarge = total > N;
+    }
+
+    // 写入一段数据，超出容量时返回 false
+    bool append(const uint8_t *data, size_t size, size_t index) {
+        if (tooLarge) {
+            return false;
+        }
+        if (index + size > N) {
+            tooLarge = true;
+            return false;
+        }
+        memcpy(buffer + index, data, size);
+        len = index + size;
+        return true;
+    }
+
+    const char *data() const {
+        return buffer;
+    }
+
+    size_t length() const {
+        return len;
+    }
+
+    bool isTooLarge() const {
+        return tooLarge;
+    }
+};
+
+#endif // BODY_BUFFER_H
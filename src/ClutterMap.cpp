@@ -0,0 +1,135 @@
+#include "ClutterMap.h"
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+ClutterMap::ClutterMap() {
+    reset();
+}
+
+void ClutterMap::reset() {
+    memset(counts, 0, sizeof(counts));
+    memset(mask, 0, sizeof(mask));
+    decayRow = 0;
+    maskedCells = 0;
+    suppressed = 0;
+}
+
+int16_t ClutterMap::cellOf(const RadarTarget &target) {
+    const uint8_t row = target.distance / CLUTTER_RANGE_BIN_M;
+    const int16_t col = (target.angle - CLUTTER_ANGLE_MIN_DEG) / CLUTTER_ANGLE_BIN_DEG;
+    if (row >= CLUTTER_RANGE_BINS || target.angle < CLUTTER_ANGLE_MIN_DEG || col >= CLUTTER_ANGLE_BINS) {
+        return -1;
+    }
+    return row * CLUTTER_ANGLE_BINS + col;
+}
+
+uint8_t ClutterMap::getCount(uint16_t cell) const {
+    const uint8_t b = counts[cell >> 1];
+    return (cell & 1) ? b >> 4 : b & 0x0F;
+}
+
+void ClutterMap::setCount(uint16_t cell, uint8_t value) {
+    uint8_t &b = counts[cell >> 1];
+    b = (cell & 1) ? (uint8_t) ((b & 0x0F) | (value << 4)) : (uint8_t) ((b & 0xF0) | value);
+}
+
+bool ClutterMap::isMasked(uint16_t cell) const {
+    return (mask[cell >> 3] >> (cell & 7)) & 1;
+}
+
+void ClutterMap::setMasked(uint16_t cell, bool masked) {
+    if (masked == isMasked(cell)) {
+        return;
+    }
+    if (masked) {
+        mask[cell >> 3] |= 1 << (cell & 7);
+        maskedCells++;
+    } else {
+        mask[cell >> 3] &= ~(1 << (cell & 7));
+        maskedCells--;
+    }
+}
+
+void ClutterMap::observe(const RadarTarget *targets, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        const int16_t cell = cellOf(targets[i]);
+        if (cell < 0) {
+            continue;
+        }
+        bool seen = false;
+        for (uint8_t j = 0; j < i && !seen; j++) {
+            seen = cellOf(targets[j]) == cell;
+        }
+        if (seen) {
+            continue;
+        }
+        const uint8_t c = getCount(cell);
+        if (c < CLUTTER_COUNT_MAX) {
+            setCount(cell, c + 1);
+        }
+        if (c + 1 >= CLUTTER_ON_COUNT) {
+            setMasked(cell, true);
+        }
+    }
+    // 轮流衰减一行，每帧开销固定，不随网格大小增长
+    const uint16_t first = decayRow * CLUTTER_ANGLE_BINS;
+    for (uint16_t cell = first; cell < first + CLUTTER_ANGLE_BINS; cell++) {
+        const uint8_t c = getCount(cell);
+        if (c == 0) {
+            continue;
+        }
+        const uint8_t next = c > CLUTTER_DECAY ? c - CLUTTER_DECAY : 0;
+        setCount(cell, next);
+        if (next <= CLUTTER_OFF_COUNT) {
+            setMasked(cell, false);
+        }
+    }
+    decayRow = (decayRow + 1) % CLUTTER_RANGE_BINS;
+}
+
+bool ClutterMap::suppress(const RadarTarget &target) {
+    const int16_t cell = cellOf(target);
+    if (cell < 0 || !isMasked(cell)) {
+        return false;
+    }
+    suppressed++;
+    return true;
+}
+
+void ClutterMap::writeJson(Print &out) const {
+    out.print("{\"rangeBinM\":");
+    out.print(CLUTTER_RANGE_BIN_M);
+    out.print(",\"rangeBins\":");
+    out.print(CLUTTER_RANGE_BINS);
+    out.print(",\"angleBinDeg\":");
+    out.print(CLUTTER_ANGLE_BIN_DEG);
+    out.print(",\"angleMinDeg\":");
+    out.print(CLUTTER_ANGLE_MIN_DEG);
+    out.print(",\"angleBins\":");
+    out.print(CLUTTER_ANGLE_BINS);
+    out.print(",\"onCount\":");
+    out.print(CLUTTER_ON_COUNT);
+    out.print(",\"offCount\":");
+    out.print(CLUTTER_OFF_COUNT);
+    out.print(",\"maskedCells\":");
+    out.print(maskedCells);
+    out.print(",\"suppressed\":");
+    out.print(suppressed);
+    // 每个距离格一行，从左到右角度递增：普通格为十六进制计数，杂波格为 #
+    out.print(",\"rows\":[");
+    for (uint8_t row = 0; row < CLUTTER_RANGE_BINS; row++) {
+        if (row > 0) {
+            out.print(',');
+        }
+        char line[CLUTTER_ANGLE_BINS + 3];
+        line[0] = '"';
+        for (uint8_t col = 0; col < CLUTTER_ANGLE_BINS; col++) {
+            const uint16_t cell = row * CLUTTER_ANGLE_BINS + col;
+            line[col + 1] = isMasked(cell) ? '#' : HEX_DIGITS[getCount(cell)];
+        }
+        line[CLUTTER_ANGLE_BINS + 1] = '"';
+        line[CLUTTER_ANGLE_BINS + 2] = '\0';
+        out.print(line);
+    }
+    out.print("]}");
+}
@@ -0,0 +1,57 @@
+#ifndef CLUTTER_MAP_H
+#define CLUTTER_MAP_H
+
+#include <Arduino.h>
+#include "RadarSensor.h"
+
+#define CLUTTER_RANGE_BIN_M 1
+#define CLUTTER_RANGE_BINS 16           // 只在 16m 以内学习与抑制，货架、挡泥板、拖车都在此范围
+#define CLUTTER_ANGLE_BIN_DEG 4
+#define CLUTTER_ANGLE_MIN_DEG (-44)
+#define CLUTTER_ANGLE_BINS 22           // 覆盖车身坐标 -44°~44°（侧向雷达 30° + 视场 12°）
+#define CLUTTER_CELLS (CLUTTER_RANGE_BINS * CLUTTER_ANGLE_BINS)
+#define CLUTTER_COUNT_MAX 15            // 4 位计数上限
+#define CLUTTER_ON_COUNT 12             // 计数达到此值判为杂波
+#define CLUTTER_OFF_COUNT 3             // 计数衰减到此值以下解除，留出迟滞避免反复切换
+#define CLUTTER_DECAY 8                 // 每帧只衰减一行，每格每 16 帧衰减 8：命中率明显超过一半的格子才会累积
+
+static_assert(CLUTTER_CELLS % 2 == 0, "每字节存两格计数");
+
+// 静态杂波图：距离×角度网格，每格 4 位计数加 1 位杂波标记，共 220 字节。
+// 学习的是通过预警筛选（靠近、速度达标）的目标，不看速度大小：随车身固定的反射（货架、挡泥板、车轮）
+// 几乎每帧落在同一格，计数持续累积；真实车辆逐帧穿过不同距离格，每格只停留几帧，计数很快衰减
+class ClutterMap {
+private:
+    uint8_t counts[CLUTTER_CELLS / 2];
+    uint8_t mask[(CLUTTER_CELLS + 7) / 8];
+    uint8_t decayRow;
+    uint16_t maskedCells;
+    uint32_t suppressed;        // 被抑制的目标数
+
+    // 目标所在格子，超出网格返回 -1
+    static int16_t cellOf(const RadarTarget &target);
+
+    uint8_t getCount(uint16_t cell) const;
+
+    void setCount(uint16_t cell, uint8_t value);
+
+    bool isMasked(uint16_t cell) const;
+
+    void setMasked(uint16_t cell, bool masked);
+
+public:
+    ClutterMap();
+
+    void reset();
+
+    // 每收到一轮雷达数据调用一次（包括无目标的帧），传入通过预警筛选的目标；
+    // 同一格一帧只计一次，耗时 O(目标数² + 每行格数)，目标数最多几十个
+    void observe(const RadarTarget *targets, uint8_t count);
+
+    // 目标落在杂波格中时返回 true 并计数
+    bool suppress(const RadarTarget &target);
+
+    void writeJson(Print &out) const;
+};
+
+#endif // CLUTTER_MAP_H
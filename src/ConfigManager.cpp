@@ -18,33 +18,41 @@ void ConfigManager::setDefaultConfig() {
     config.blinkDuration = 2;
     config.audioEnabled = true;
     config.audioI2S = true;
+    config.audioSynth = false;
     config.startAudio = true;
     config.logEnabled = false;
+    config.trackEnabled = true;
+    config.clutterFilter = true;
+    config.linkWindowMs = 2000;
+    config.telemetryEnabled = false;
+    config.telemetryPort = 4210;
+    config.telemetrySsid[0] = '\0';
+    config.telemetryPassword[0] = '\0';
+    config.activeProfile = 0;
+    config.profileName[0] = '\0';
 
-    // 默认实际时长（同时作为最大播放时长） normal 2s，其它 1s
-    config.audioDurationMsNormal = 2000;
-    config.audioDurationMsDanger = 1000;
-    config.audioDurationMsLeft = 1000;
-    config.audioDurationMsRight = 1000;
-    config.audioDurationMsRear = 1000;
-    config.audioDurationMsStart = 1000;
+    // 默认实际时长（同时作为最大播放时长）取自音效目录
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        config.audioDurationMs[i] = ALERT_CATALOG[i].defaultDurationMs;
+    }
 }
 
 bool ConfigManager::loadConfig() {
     // Serial.println("开始加载配置文件");
     if (!LittleFS.begin()) {
         setDefaultConfig();
+        loadProfiles();
         return true;
     }
     File file = LittleFS.open(configFilePath, "r");
     if (!file) {
         setDefaultConfig();
+        loadProfiles();
         return true;
     }
-    String jsonString = file.readString();
+    doc.clear();
+    deserializeJson(doc, file);
     file.close();
-    DynamicJsonDocument doc(1024);
-    deserializeJson(doc, jsonString);
     config.detectionDistance = doc["detectionDistance"] | config.detectionDistance;
     config.detectionSpeed = doc["detectionSpeed"] | config.detectionSpeed;
     config.dangerDistance = doc["dangerDistance"] | config.dangerDistance;
@@ -58,24 +66,85 @@ bool ConfigManager::loadConfig() {
     config.blinkDuration = doc["blinkDuration"] | config.blinkDuration;
     config.audioEnabled = doc["audioEnabled"] | config.audioEnabled;
     config.audioI2S = doc["audioI2S"] | config.audioI2S;
+    config.audioSynth = doc["audioSynth"] | config.audioSynth;
     config.startAudio = doc["startAudio"] | config.startAudio;
     config.logEnabled = doc["logEnabled"] | config.logEnabled;
+    config.trackEnabled = doc["trackEnabled"] | config.trackEnabled;
+    config.clutterFilter = doc["clutterFilter"] | config.clutterFilter;
+    config.linkWindowMs = doc["linkWindowMs"] | config.linkWindowMs;
+    config.telemetryEnabled = doc["telemetryEnabled"] | config.telemetryEnabled;
+    config.telemetryPort = doc["telemetryPort"] | config.telemetryPort;
+    strlcpy(config.telemetrySsid, doc["telemetrySsid"] | "", sizeof(config.telemetrySsid));
+    strlcpy(config.telemetryPassword, doc["telemetryPassword"] | "", sizeof(config.telemetryPassword));
 
     // 读取实际时长（同时作为最大播放时长）
-    config.audioDurationMsNormal = doc["audioDurationMsNormal"] | config.audioDurationMsNormal;
-    config.audioDurationMsDanger = doc["audioDurationMsDanger"] | config.audioDurationMsDanger;
-    config.audioDurationMsLeft = doc["audioDurationMsLeft"] | config.audioDurationMsLeft;
-    config.audioDurationMsRight = doc["audioDurationMsRight"] | config.audioDurationMsRight;
-    config.audioDurationMsRear = doc["audioDurationMsRear"] | config.audioDurationMsRear;
-    config.audioDurationMsStart = doc["audioDurationMsStart"] | config.audioDurationMsStart;
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        config.audioDurationMs[i] = doc[ALERT_CATALOG[i].durationKey] | config.audioDurationMs[i];
+    }
+    loadProfiles();
     return true;
 }
 
+void ConfigManager::loadProfiles() {
+    // 首次启动没有档位文件时，以 config.json 的设置为默认档位并立即落盘。
+    // 此后档位只从 /profiles.bin 读取，config.json 中的档位字段（保存时写入的是当前档位）不会再被当作默认档位
+    if (!profiles.load()) {
+        RideProfile base;
+        toProfile(config, base);
+        profiles.seed(base);
+        profiles.save();
+    }
+    copyActiveProfile();
+}
+
+void ConfigManager::toProfile(const RadarConfig &cfg, RideProfile &profile) {
+    memset(&profile, 0, sizeof(profile));
+    strlcpy(profile.name, cfg.profileName, sizeof(profile.name));
+    profile.detectionDistance = (uint8_t) constrain(cfg.detectionDistance, 0, 255);
+    profile.detectionSpeed = (uint8_t) constrain(cfg.detectionSpeed, 0, 255);
+    profile.dangerDistance = (uint8_t) constrain(cfg.dangerDistance, 0, 255);
+    profile.dangerSpeed = (uint8_t) constrain(cfg.dangerSpeed, 0, 255);
+    profile.normalBlinkInterval = (uint16_t) constrain(cfg.normalBlinkInterval, 0, 65535);
+    profile.dangerBlinkInterval = (uint16_t) constrain(cfg.dangerBlinkInterval, 0, 65535);
+    profile.blinkDuration = (uint8_t) constrain(cfg.blinkDuration, 0, 255);
+    profile.centerAngle = (uint8_t) constrain(cfg.centerAngle, 0, 127);
+    profile.flags = (cfg.lightBlink ? PROFILE_LIGHT_BLINK : 0) | (cfg.lightAngle ? PROFILE_LIGHT_ANGLE : 0);
+    profile.gainTenths = (uint8_t) constrain(lroundf(cfg.warningGain * 10.0f), 0L, 255L);
+}
+
+void ConfigManager::copyActiveProfile() {
+    const uint8_t index = profiles.getActive();
+    const RideProfile &p = profiles.get(index);
+    config.activeProfile = index;
+    strlcpy(config.profileName, p.name, sizeof(config.profileName));
+    config.detectionDistance = p.detectionDistance;
+    config.detectionSpeed = p.detectionSpeed;
+    config.dangerDistance = p.dangerDistance;
+    config.dangerSpeed = p.dangerSpeed;
+    config.normalBlinkInterval = p.normalBlinkInterval;
+    config.dangerBlinkInterval = p.dangerBlinkInterval;
+    config.blinkDuration = p.blinkDuration;
+    config.centerAngle = p.centerAngle;
+    config.lightBlink = (p.flags & PROFILE_LIGHT_BLINK) != 0;
+    config.lightAngle = (p.flags & PROFILE_LIGHT_ANGLE) != 0;
+    config.warningGain = p.gainTenths / 10.0f;
+}
+
+uint8_t ConfigManager::nextProfile() {
+    const uint8_t index = profiles.next();
+    copyActiveProfile();
+    return index;
+}
+
+const RideProfileState &ConfigManager::getProfileState() const {
+    return profiles.current();
+}
+
 bool ConfigManager::saveConfig() {
     if (!LittleFS.begin()) {
         return false;
     }
-    DynamicJsonDocument doc(1024);
+    doc.clear();
     doc["detectionDistance"] = config.detectionDistance;
     doc["detectionSpeed"] = config.detectionSpeed;
     doc["dangerDistance"] = config.dangerDistance;
@@ -89,16 +158,21 @@ bool ConfigManager::saveConfig() {
     doc["blinkDuration"] = config.blinkDuration;
     doc["audioEnabled"] = config.audioEnabled;
     doc["audioI2S"] = config.audioI2S;
+    doc["audioSynth"] = config.audioSynth;
     doc["startAudio"] = config.startAudio;
     doc["logEnabled"] = config.logEnabled;
+    doc["trackEnabled"] = config.trackEnabled;
+    doc["clutterFilter"] = config.clutterFilter;
+    doc["linkWindowMs"] = config.linkWindowMs;
+    doc["telemetryEnabled"] = config.telemetryEnabled;
+    doc["telemetryPort"] = config.telemetryPort;
+    doc["telemetrySsid"] = config.telemetrySsid;
+    doc["telemetryPassword"] = config.telemetryPassword;
 
     // 实际时长（同时作为最大播放时长）
-    doc["audioDurationMsNormal"] = config.audioDurationMsNormal;
-    doc["audioDurationMsDanger"] = config.audioDurationMsDanger;
-    doc["audioDurationMsLeft"] = config.audioDurationMsLeft;
-    doc["audioDurationMsRight"] = config.audioDurationMsRight;
-    doc["audioDurationMsRear"] = config.audioDurationMsRear;
-    doc["audioDurationMsStart"] = config.audioDurationMsStart;
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        doc[ALERT_CATALOG[i].durationKey] = config.audioDurationMs[i];
+    }
     File file = LittleFS.open(configFilePath, "w");
     if (!file) {
         return false;
@@ -108,32 +182,258 @@ bool ConfigManager::saveConfig() {
     return true;
 }
 
+// 读取单个字段：缺省时跳过，类型不符时记录字段名
+template<typename T>
+static void patchField(JsonObjectConst obj, const char *key, T &dst, uint32_t bit, uint32_t &changed,
+                       const char *&badField) {
+    JsonVariantConst v = obj[key];
+    if (v.isNull()) {
+        return;
+    }
+    if (!v.is<T>()) {
+        if (badField == nullptr) {
+            badField = key;
+        }
+        return;
+    }
+    const T value = v.as<T>();
+    if (value != dst) {
+        dst = value;
+        changed |= bit;
+    }
+}
+
+// 读取定长字符串字段，超长视为类型错误
+static void patchText(JsonObjectConst obj, const char *key, char *dst, size_t size, uint32_t bit,
+                      uint32_t &changed, const char *&badField) {
+    JsonVariantConst v = obj[key];
+    if (v.isNull()) {
+        return;
+    }
+    const char *value = v.as<const char *>();
+    if (!v.is<const char *>() || strlen(value) >= size) {
+        if (badField == nullptr) {
+            badField = key;
+        }
+        return;
+    }
+    if (strcmp(value, dst) != 0) {
+        strlcpy(dst, value, size);
+        changed |= bit;
+    }
+}
+
+// 数值范围检查，只检查本次提交中发生变化的字段
+template<typename T>
+static void checkRange(uint32_t changed, uint32_t bit, T value, T low, T high, const char *key,
+                       const char *&badField) {
+    if ((changed & bit) && badField == nullptr && (value < low || value > high)) {
+        badField = key;
+    }
+}
+
+bool ConfigManager::parsePatch(const char *json, size_t len, ConfigPatch &patch) const {
+    patch.values = config;
+    patch.changed = 0;
+    patch.error = nullptr;
+    patch.field = nullptr;
+    doc.clear();
+    DeserializationError err = deserializeJson(doc, json, len);
+    if (err) {
+        patch.error = err == DeserializationError::NoMemory ? "配置字段过多" : "JSON 格式错误";
+        return false;
+    }
+    if (!doc.is<JsonObject>()) {
+        patch.error = "配置必须为 JSON 对象";
+        return false;
+    }
+    JsonObjectConst obj = doc.as<JsonObjectConst>();
+    RadarConfig &v = patch.values;
+    uint32_t &c = patch.changed;
+    const char *bad = nullptr;
+    patchField(obj, "warningGain", v.warningGain, CFG_WARNING_GAIN, c, bad);
+    patchField(obj, "detectionDistance", v.detectionDistance, CFG_DETECTION_DISTANCE, c, bad);
+    patchField(obj, "detectionSpeed", v.detectionSpeed, CFG_DETECTION_SPEED, c, bad);
+    patchField(obj, "dangerDistance", v.dangerDistance, CFG_DANGER_DISTANCE, c, bad);
+    patchField(obj, "dangerSpeed", v.dangerSpeed, CFG_DANGER_SPEED, c, bad);
+    patchField(obj, "lightBlink", v.lightBlink, CFG_LIGHT_BLINK, c, bad);
+    patchField(obj, "blinkDuration", v.blinkDuration, CFG_BLINK_DURATION, c, bad);
+    patchField(obj, "normalBlinkInterval", v.normalBlinkInterval, CFG_NORMAL_BLINK_INTERVAL, c, bad);
+    patchField(obj, "dangerBlinkInterval", v.dangerBlinkInterval, CFG_DANGER_BLINK_INTERVAL, c, bad);
+    patchField(obj, "lightAngle", v.lightAngle, CFG_LIGHT_ANGLE, c, bad);
+    patchField(obj, "centerAngle", v.centerAngle, CFG_CENTER_ANGLE, c, bad);
+    patchField(obj, "audioEnabled", v.audioEnabled, CFG_AUDIO_ENABLED, c, bad);
+    patchField(obj, "audioI2S", v.audioI2S, CFG_AUDIO_I2S, c, bad);
+    patchField(obj, "audioSynth", v.audioSynth, CFG_AUDIO_SYNTH, c, bad);
+    patchField(obj, "startAudio", v.startAudio, CFG_START_AUDIO, c, bad);
+    patchField(obj, "logEnabled", v.logEnabled, CFG_LOG_ENABLED, c, bad);
+    patchField(obj, "trackEnabled", v.trackEnabled, CFG_TRACK_ENABLED, c, bad);
+    patchField(obj, "clutterFilter", v.clutterFilter, CFG_CLUTTER_FILTER, c, bad);
+    patchField(obj, "linkWindowMs", v.linkWindowMs, CFG_LINK_WINDOW, c, bad);
+    patchField(obj, "telemetryEnabled", v.telemetryEnabled, CFG_TELEMETRY_ENABLED, c, bad);
+    patchField(obj, "telemetryPort", v.telemetryPort, CFG_TELEMETRY_PORT, c, bad);
+    patchText(obj, "telemetrySsid", v.telemetrySsid, sizeof(v.telemetrySsid), CFG_TELEMETRY_SSID, c, bad);
+    patchText(obj, "telemetryPassword", v.telemetryPassword, sizeof(v.telemetryPassword), CFG_TELEMETRY_PASSWORD,
+              c, bad);
+    patchField(obj, "activeProfile", v.activeProfile, CFG_ACTIVE_PROFILE, c, bad);
+    patchText(obj, "profileName", v.profileName, sizeof(v.profileName), CFG_PROFILE_NAME, c, bad);
+
+    // 实际音频时长（同时作为最大播放时长）
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        patchField(obj, ALERT_CATALOG[i].durationKey, v.audioDurationMs[i], CFG_AUDIO_DURATION << i, c, bad);
+    }
+    if (bad != nullptr) {
+        patch.error = "字段类型错误";
+        patch.field = bad;
+        return false;
+    }
+    // 范围与网页输入控件一致；距离、速度与间隔以 uint8/uint16 存入档位，链路窗口以 uint16 传给链路监测
+    checkRange(c, CFG_WARNING_GAIN, v.warningGain, 0.0f, 3.5f, "warningGain", bad);
+    checkRange(c, CFG_DETECTION_DISTANCE, v.detectionDistance, 1, 100, "detectionDistance", bad);
+    checkRange(c, CFG_DETECTION_SPEED, v.detectionSpeed, 1, 120, "detectionSpeed", bad);
+    checkRange(c, CFG_DANGER_DISTANCE, v.dangerDistance, 1, 30, "dangerDistance", bad);
+    checkRange(c, CFG_DANGER_SPEED, v.dangerSpeed, 10, 120, "dangerSpeed", bad);
+    checkRange(c, CFG_BLINK_DURATION, v.blinkDuration, 1, 5, "blinkDuration", bad);
+    checkRange(c, CFG_NORMAL_BLINK_INTERVAL, v.normalBlinkInterval, 100, 2000, "normalBlinkInterval", bad);
+    checkRange(c, CFG_DANGER_BLINK_INTERVAL, v.dangerBlinkInterval, 50, 1000, "dangerBlinkInterval", bad);
+    checkRange(c, CFG_CENTER_ANGLE, v.centerAngle, 0, 5, "centerAngle", bad);
+    checkRange(c, CFG_LINK_WINDOW, v.linkWindowMs, 200, 60000, "linkWindowMs", bad);
+    checkRange(c, CFG_TELEMETRY_PORT, v.telemetryPort, 1, 65535, "telemetryPort", bad);
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        checkRange(c, CFG_AUDIO_DURATION << i, v.audioDurationMs[i], 0UL, 60000UL, ALERT_CATALOG[i].durationKey, bad);
+    }
+    if (bad != nullptr) {
+        patch.error = "字段超出范围";
+        patch.field = bad;
+        return false;
+    }
+    if ((c & CFG_ACTIVE_PROFILE) && (v.activeProfile < 0 || v.activeProfile >= profiles.getCount())) {
+        patch.error = "档位不存在";
+        patch.field = "activeProfile";
+        return false;
+    }
+    return true;
+}
+
+// 只复制 changed 标记的字段
+static void mergePatch(RadarConfig &dst, const RadarConfig &src, uint32_t changed) {
+    if (changed & CFG_WARNING_GAIN) {
+        dst.warningGain = src.warningGain;
+    }
+    if (changed & CFG_DETECTION_DISTANCE) {
+        dst.detectionDistance = src.detectionDistance;
+    }
+    if (changed & CFG_DETECTION_SPEED) {
+        dst.detectionSpeed = src.detectionSpeed;
+    }
+    if (changed & CFG_DANGER_DISTANCE) {
+        dst.dangerDistance = src.dangerDistance;
+    }
+    if (changed & CFG_DANGER_SPEED) {
+        dst.dangerSpeed = src.dangerSpeed;
+    }
+    if (changed & CFG_LIGHT_BLINK) {
+        dst.lightBlink = src.lightBlink;
+    }
+    if (changed & CFG_BLINK_DURATION) {
+        dst.blinkDuration = src.blinkDuration;
+    }
+    if (changed & CFG_NORMAL_BLINK_INTERVAL) {
+        dst.normalBlinkInterval = src.normalBlinkInterval;
+    }
+    if (changed & CFG_DANGER_BLINK_INTERVAL) {
+        dst.dangerBlinkInterval = src.dangerBlinkInterval;
+    }
+    if (changed & CFG_LIGHT_ANGLE) {
+        dst.lightAngle = src.lightAngle;
+    }
+    if (changed & CFG_CENTER_ANGLE) {
+        dst.centerAngle = src.centerAngle;
+    }
+    if (changed & CFG_AUDIO_ENABLED) {
+        dst.audioEnabled = src.audioEnabled;
+    }
+    if (changed & CFG_AUDIO_I2S) {
+        dst.audioI2S = src.audioI2S;
+    }
+    if (changed & CFG_AUDIO_SYNTH) {
+        dst.audioSynth = src.audioSynth;
+    }
+    if (changed & CFG_START_AUDIO) {
+        dst.startAudio = src.startAudio;
+    }
+    if (changed & CFG_LOG_ENABLED) {
+        dst.logEnabled = src.logEnabled;
+    }
+    if (changed & CFG_TRACK_ENABLED) {
+        dst.trackEnabled = src.trackEnabled;
+    }
+    if (changed & CFG_CLUTTER_FILTER) {
+        dst.clutterFilter = src.clutterFilter;
+    }
+    if (changed & CFG_LINK_WINDOW) {
+        dst.linkWindowMs = src.linkWindowMs;
+    }
+    if (changed & CFG_TELEMETRY_ENABLED) {
+        dst.telemetryEnabled = src.telemetryEnabled;
+    }
+    if (changed & CFG_TELEMETRY_PORT) {
+        dst.telemetryPort = src.telemetryPort;
+    }
+    if (changed & CFG_TELEMETRY_SSID) {
+        strlcpy(dst.telemetrySsid, src.telemetrySsid, sizeof(dst.telemetrySsid));
+    }
+    if (changed & CFG_TELEMETRY_PASSWORD) {
+        strlcpy(dst.telemetryPassword, src.telemetryPassword, sizeof(dst.telemetryPassword));
+    }
+    if (changed & CFG_ACTIVE_PROFILE) {
+        dst.activeProfile = src.activeProfile;
+    }
+    if (changed & CFG_PROFILE_NAME) {
+        strlcpy(dst.profileName, src.profileName, sizeof(dst.profileName));
+    }
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        if (changed & (CFG_AUDIO_DURATION << i)) {
+            dst.audioDurationMs[i] = src.audioDurationMs[i];
+        }
+    }
+}
+
+bool ConfigManager::applyPatch(const ConfigPatch &patch) {
+    if (patch.changed == 0) {
+        return true;
+    }
+    mergePatch(config, patch.values, patch.changed);
+    bool profilesSaved = true;
+    if (patch.changed & CFG_ACTIVE_PROFILE) {
+        // 网页切换档位同时设为开机档位；同一请求中的档位字段以切换后的档位为准
+        profiles.select((uint8_t) config.activeProfile);
+        profiles.setBootProfile((uint8_t) config.activeProfile);
+        copyActiveProfile();
+        profilesSaved = profiles.save();
+    } else if (patch.changed & CFG_PROFILE_FIELDS) {
+        RideProfile profile;
+        toProfile(config, profile);
+        profiles.update(profiles.getActive(), profile);
+        copyActiveProfile();
+        profilesSaved = profiles.save();
+    }
+    return saveConfig() && profilesSaved;
+}
+
 bool ConfigManager::updateConfig(const String &jsonString) {
-    StaticJsonDocument<1024> doc;
-    deserializeJson(doc, jsonString);
-    config.detectionDistance = doc["detectionDistance"] | config.detectionDistance;
-    config.detectionSpeed = doc["detectionSpeed"] | config.detectionSpeed;
-    config.dangerDistance = doc["dangerDistance"] | config.dangerDistance;
-    config.dangerSpeed = doc["dangerSpeed"] | config.dangerSpeed;
-    config.warningGain = doc["warningGain"] | config.warningGain;
-    config.lightBlink = doc["lightBlink"] | config.lightBlink;
-    config.blinkDuration = doc["blinkDuration"] | config.blinkDuration;
-    config.normalBlinkInterval = doc["normalBlinkInterval"] | config.normalBlinkInterval;
-    config.dangerBlinkInterval = doc["dangerBlinkInterval"] | config.dangerBlinkInterval;
-    config.audioEnabled = doc["audioEnabled"] | config.audioEnabled;
-    config.audioI2S = doc["audioI2S"] | config.audioI2S;
-    config.lightAngle = doc["lightAngle"] | config.lightAngle;
-    config.centerAngle = doc["centerAngle"] | config.centerAngle;
-    config.startAudio = doc["startAudio"] | config.startAudio;
-    config.logEnabled = doc["logEnabled"] | config.logEnabled;
+    ConfigPatch patch;
+    if (!parsePatch(jsonString.c_str(), jsonString.length(), patch)) {
+        return false;
+    }
+    return applyPatch(patch);
+}
 
-    // 更新实际音频时长（同时作为最大播放时长）
-    config.audioDurationMsNormal = doc["audioDurationMsNormal"] | config.audioDurationMsNormal;
-    config.audioDurationMsDanger = doc["audioDurationMsDanger"] | config.audioDurationMsDanger;
-    config.audioDurationMsLeft = doc["audioDurationMsLeft"] | config.audioDurationMsLeft;
-    config.audioDurationMsRight = doc["audioDurationMsRight"] | config.audioDurationMsRight;
-    config.audioDurationMsRear = doc["audioDurationMsRear"] | config.audioDurationMsRear;
-    config.audioDurationMsStart = doc["audioDurationMsStart"] | config.audioDurationMsStart;
+bool ConfigManager::setAudioDuration(AlertId id, unsigned long durationMs) {
+    if (id >= ALERT_COUNT || config.audioDurationMs[id] == durationMs) {
+        return true;
+    }
+    config.audioDurationMs[id] = durationMs;
     return saveConfig();
 }
 
@@ -141,8 +441,8 @@ const RadarConfig &ConfigManager::getConfig() const {
     return config;
 }
 
-String ConfigManager::getConfigJson() const {
-    DynamicJsonDocument doc(1024);
+void ConfigManager::writeConfigJson(Print &out) const {
+    doc.clear();
     doc["warningGain"] = config.warningGain;
     doc["detectionDistance"] = config.detectionDistance;
     doc["detectionSpeed"] = config.detectionSpeed;
@@ -156,17 +456,43 @@ String ConfigManager::getConfigJson() const {
     doc["blinkDuration"] = config.blinkDuration;
     doc["audioEnabled"] = config.audioEnabled;
     doc["audioI2S"] = config.audioI2S;
+    doc["audioSynth"] = config.audioSynth;
     doc["startAudio"] = config.startAudio;
     doc["logEnabled"] = config.logEnabled;
+    doc["trackEnabled"] = config.trackEnabled;
+    doc["clutterFilter"] = config.clutterFilter;
+    doc["linkWindowMs"] = config.linkWindowMs;
+    doc["telemetryEnabled"] = config.telemetryEnabled;
+    doc["telemetryPort"] = config.telemetryPort;
+    doc["telemetrySsid"] = config.telemetrySsid;
+    // 不回传密码，只告知是否已设置
+    doc["telemetryPasswordSet"] = config.telemetryPassword[0] != '\0';
+
+    // 全部档位与当前、开机档位
+    doc["activeProfile"] = config.activeProfile;
+    doc["profileName"] = config.profileName;
+    doc["bootProfile"] = profiles.getBootProfile();
+    JsonArray list = doc.createNestedArray("profiles");
+    for (uint8_t i = 0; i < profiles.getCount(); i++) {
+        const RideProfile &p = profiles.get(i);
+        JsonObject o = list.createNestedObject();
+        o["name"] = (const char *) p.name;
+        o["detectionDistance"] = p.detectionDistance;
+        o["detectionSpeed"] = p.detectionSpeed;
+        o["dangerDistance"] = p.dangerDistance;
+        o["dangerSpeed"] = p.dangerSpeed;
+        o["lightBlink"] = (p.flags & PROFILE_LIGHT_BLINK) != 0;
+        o["blinkDuration"] = p.blinkDuration;
+        o["normalBlinkInterval"] = p.normalBlinkInterval;
+        o["dangerBlinkInterval"] = p.dangerBlinkInterval;
+        o["lightAngle"] = (p.flags & PROFILE_LIGHT_ANGLE) != 0;
+        o["centerAngle"] = p.centerAngle;
+        o["warningGain"] = p.gainTenths / 10.0f;
+    }
 
     // 实际时长（同时作为最大播放时长）
-    doc["audioDurationMsNormal"] = config.audioDurationMsNormal;
-    doc["audioDurationMsDanger"] = config.audioDurationMsDanger;
-    doc["audioDurationMsLeft"] = config.audioDurationMsLeft;
-    doc["audioDurationMsRight"] = config.audioDurationMsRight;
-    doc["audioDurationMsRear"] = config.audioDurationMsRear;
-    doc["audioDurationMsStart"] = config.audioDurationMsStart;
-    String result;
-    serializeJson(doc, result);
-    return result;
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        doc[ALERT_CATALOG[i].durationKey] = config.audioDurationMs[i];
+    }
+    serializeJson(doc, out);
 }
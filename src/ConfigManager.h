@@ -1,6 +1,11 @@
 #ifndef CONFIG_MANAGER_H
 #define CONFIG_MANAGER_H
 #include <Arduino.h>
+#include <ArduinoJson.h>
+#include "AlertCatalog.h"
+#include "RideProfiles.h"
+
+#define CONFIG_JSON_CAPACITY 2048   // 配置读写共用的 JSON 文档容量（含档位列表）
 
 struct RadarConfig {
     float warningGain;
@@ -16,25 +21,90 @@ struct RadarConfig {
     int centerAngle;
     bool audioEnabled;
     bool audioI2S;
+    bool audioSynth;    // true: 程序合成提示音，false: 播放 mp3 音效
     bool startAudio;    // 是否播放启动音效
     bool logEnabled;
+    bool trackEnabled;  // 骑行轨迹记录
+    bool clutterFilter; // 学习并抑制相对车身静止的杂波
+    int linkWindowMs;   // 雷达链路检测窗口：无帧或错误过多超过该时长即判为故障并自动恢复
+    bool telemetryEnabled;          // UDP 遥测
+    int telemetryPort;
+    char telemetrySsid[33];         // 为空时开启热点，否则连接该路由器
+    char telemetryPassword[65];
+    // 当前骑行档位；上面的距离、速度、灯光与音量字段始终是该档位的值
+    int activeProfile;
+    char profileName[RIDE_PROFILE_NAME_LEN];
+
+    // 各音效的实际时长（毫秒），下标为 AlertId，在上传音效后填充
+    unsigned long audioDurationMs[ALERT_COUNT];
+};
+
+// 配置字段变更位，用于 ConfigPatch::changed
+enum ConfigField : uint32_t {
+    CFG_WARNING_GAIN = 1UL << 0,
+    CFG_DETECTION_DISTANCE = 1UL << 1,
+    CFG_DETECTION_SPEED = 1UL << 2,
+    CFG_DANGER_DISTANCE = 1UL << 3,
+    CFG_DANGER_SPEED = 1UL << 4,
+    CFG_LIGHT_BLINK = 1UL << 5,
+    CFG_BLINK_DURATION = 1UL << 6,
+    CFG_NORMAL_BLINK_INTERVAL = 1UL << 7,
+    CFG_DANGER_BLINK_INTERVAL = 1UL << 8,
+    CFG_LIGHT_ANGLE = 1UL << 9,
+    CFG_CENTER_ANGLE = 1UL << 10,
+    CFG_AUDIO_ENABLED = 1UL << 11,
+    CFG_AUDIO_I2S = 1UL << 12,
+    CFG_AUDIO_SYNTH = 1UL << 13,
+    CFG_START_AUDIO = 1UL << 14,
+    CFG_LOG_ENABLED = 1UL << 15,
+    CFG_AUDIO_DURATION = 1UL << 16,     // 第 i 个音效时长为 CFG_AUDIO_DURATION << i，占用第 16~21 位
+    CFG_TRACK_ENABLED = 1UL << 22,
+    CFG_TELEMETRY_ENABLED = 1UL << 23,
+    CFG_TELEMETRY_PORT = 1UL << 24,
+    CFG_TELEMETRY_SSID = 1UL << 25,
+    CFG_TELEMETRY_PASSWORD = 1UL << 26,
+    CFG_CLUTTER_FILTER = 1UL << 27,
+    CFG_ACTIVE_PROFILE = 1UL << 28,     // 切换档位并设为开机档位
+    CFG_PROFILE_NAME = 1UL << 29,
+    CFG_LINK_WINDOW = 1UL << 30,
+};
+
+// 属于骑行档位的字段，修改时写入当前档位
+constexpr uint32_t CFG_PROFILE_FIELDS = CFG_WARNING_GAIN | CFG_DETECTION_DISTANCE | CFG_DETECTION_SPEED
+                                        | CFG_DANGER_DISTANCE | CFG_DANGER_SPEED | CFG_LIGHT_BLINK
+                                        | CFG_BLINK_DURATION | CFG_NORMAL_BLINK_INTERVAL
+                                        | CFG_DANGER_BLINK_INTERVAL | CFG_LIGHT_ANGLE | CFG_CENTER_ANGLE
+                                        | CFG_PROFILE_NAME;
 
-    // 不同音效的实际时长（毫秒），在上传音效后填充
-    unsigned long audioDurationMsNormal;
-    unsigned long audioDurationMsDanger;
-    unsigned long audioDurationMsLeft;
-    unsigned long audioDurationMsRight;
-    unsigned long audioDurationMsRear;
-    unsigned long audioDurationMsStart;
+static_assert(ALERT_COUNT <= 6, "音效时长变更位与 CFG_TRACK_ENABLED 重叠");
+
+// 一次配置提交解析出的变更集：values 以解析时的配置为底，只有 changed 标记的字段会被应用
+struct ConfigPatch {
+    RadarConfig values;
+    uint32_t changed;
+    const char *error;  // 解析失败原因
+    const char *field;  // 类型错误或超出范围的字段名
 };
 
 class ConfigManager {
 private:
     RadarConfig config;
     const char *configFilePath = "/config.json";
+    // 加载、保存、网页读写配置共用一个预分配文档，不在堆上反复创建
+    mutable StaticJsonDocument<CONFIG_JSON_CAPACITY> doc;
+
+    RideProfiles profiles;
 
     void setDefaultConfig();
 
+    // 读取档位文件（缺失时由当前配置生成），并把当前档位写入 config
+    void loadProfiles();
+
+    static void toProfile(const RadarConfig &cfg, RideProfile &profile);
+
+    // 把当前档位的字段复制到 config
+    void copyActiveProfile();
+
 public:
     bool loadConfig();
 
@@ -42,9 +112,25 @@ public:
 
     bool updateConfig(const String &jsonString);
 
+    // 上传音效后写入设备端解析出的实际时长，无变化时不写 flash
+    bool setAudioDuration(AlertId id, unsigned long durationMs);
+
+    // 只解析一次请求体，得到与当前配置的差异；缺省字段保持不变（PATCH 语义），数值超出范围时返回 false
+    bool parsePatch(const char *json, size_t len, ConfigPatch &patch) const;
+
+    // 把变更集中标记的字段写入当前配置，无变化时不写 flash。
+    // 解析与应用之间（双击切换档位、上传音效写入时长）对其他字段的修改不会被覆盖
+    bool applyPatch(const ConfigPatch &patch);
+
     const RadarConfig &getConfig() const;
 
-    String getConfigJson() const;
+    // 按键双击：切换到下一档位并返回其下标，只改内存，不写 flash
+    uint8_t nextProfile();
+
+    // 当前档位预先计算的判断参数
+    const RideProfileState &getProfileState() const;
+
+    void writeConfigJson(Print &out) const;
 };
 
 #endif // CONFIG_MANAGER_H
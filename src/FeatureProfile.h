@@ -0,0 +1,28 @@
+#ifndef FEATURE_PROFILE_H
+#define FEATURE_PROFILE_H
+
+// 编译期功能开关，由 platformio.ini 各环境的 build_flags 设置，未设置时为完整功能。
+// 关闭的子系统连同其依赖库一起不参与编译链接（依赖库由各环境的 lib_deps 与 build_src_filter 控制）
+#ifndef RADAR_PROFILE
+#define RADAR_PROFILE "full"
+#endif
+#ifndef RADAR_FEATURE_AUDIO
+#define RADAR_FEATURE_AUDIO 1           // ESP8266Audio：mp3 音效与合成提示音
+#endif
+#ifndef RADAR_FEATURE_WEB
+#define RADAR_FEATURE_WEB 1             // ESPAsyncWebServer：配置模式网页
+#endif
+#ifndef RADAR_FEATURE_LOG
+#define RADAR_FEATURE_LOG 1             // /radar.log 日志与 2KB 缓冲
+#endif
+#ifndef RADAR_FEATURE_TELEMETRY
+#define RADAR_FEATURE_TELEMETRY 1       // UDP 遥测
+#endif
+
+// 热路径上与运行期配置合取使用，例如 FEATURE_AUDIO && cfg.audioEnabled，关闭时编译器整段删除
+constexpr bool FEATURE_AUDIO = RADAR_FEATURE_AUDIO != 0;
+constexpr bool FEATURE_WEB = RADAR_FEATURE_WEB != 0;
+constexpr bool FEATURE_LOG = RADAR_FEATURE_LOG != 0;
+constexpr bool FEATURE_TELEMETRY = RADAR_FEATURE_TELEMETRY != 0;
+
+#endif // FEATURE_PROFILE_H
@@ -0,0 +1,72 @@
+#include "HeapMonitor.h"
+
+static const char *const HEAP_STAGE_NAMES[HEAP_STAGE_COUNT] = {"setup", "radar", "web"};
+
+HeapMonitor::HeapMonitor() {
+    freeHeap = 0;
+    maxBlock = 0;
+    fragmentation = 0;
+    minFreeHeap = 0;
+    minMaxBlock = 0;
+    maxFragmentation = 0;
+    lastSampleTime = 0;
+    sampled = false;
+    memset(stages, 0, sizeof(stages));
+}
+
+void HeapMonitor::mark(HeapStage stage) {
+    stages[stage].freeHeap = ESP.getFreeHeap();
+    stages[stage].maxBlock = ESP.getMaxFreeBlockSize();
+}
+
+void HeapMonitor::sample() {
+    const unsigned long now = millis();
+    if (sampled && now - lastSampleTime < HEAP_SAMPLE_INTERVAL_MS) {
+        return;
+    }
+    lastSampleTime = now;
+    freeHeap = ESP.getFreeHeap();
+    maxBlock = ESP.getMaxFreeBlockSize();
+    fragmentation = ESP.getHeapFragmentation();
+    if (!sampled || freeHeap < minFreeHeap) {
+        minFreeHeap = freeHeap;
+    }
+    if (!sampled || maxBlock < minMaxBlock) {
+        minMaxBlock = maxBlock;
+    }
+    if (!sampled || fragmentation > maxFragmentation) {
+        maxFragmentation = fragmentation;
+    }
+    sampled = true;
+}
+
+void HeapMonitor::writeJson(Print &out) const {
+    out.print("{\"freeHeap\":");
+    out.print(freeHeap);
+    out.print(",\"maxBlock\":");
+    out.print(maxBlock);
+    out.print(",\"fragmentation\":");
+    out.print(fragmentation);
+    out.print(",\"minFreeHeap\":");
+    out.print(minFreeHeap);
+    out.print(",\"minMaxBlock\":");
+    out.print(minMaxBlock);
+    out.print(",\"maxFragmentation\":");
+    out.print(maxFragmentation);
+    out.print(",\"uptimeMs\":");
+    out.print(millis());
+    out.print(",\"stages\":{");
+    for (uint8_t i = 0; i < HEAP_STAGE_COUNT; i++) {
+        if (i > 0) {
+            out.print(',');
+        }
+        out.print('"');
+        out.print(HEAP_STAGE_NAMES[i]);
+        out.print("\":{\"freeHeap\":");
+        out.print(stages[i].freeHeap);
+        out.print(",\"maxBlock\":");
+        out.print(stages[i].maxBlock);
+        out.print('}');
+    }
+    out.print("}}");
+}
@@ -0,0 +1,46 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+
+#define HEAP_SAMPLE_INTERVAL_MS 1000
+
+// 启动过程中的堆快照：常驻缓冲（含静态区）与配置模式各自占用多少，据此决定哪些缓冲可以常驻
+enum HeapStage : uint8_t {
+    HEAP_STAGE_SETUP,           // setup 开始，静态区缓冲已计入
+    HEAP_STAGE_RADAR,           // 雷达、音频对象与 MP3 解码缓冲创建之后
+    HEAP_STAGE_WEB,             // 开启热点并启动网页服务之后（最近一次）
+    HEAP_STAGE_COUNT
+};
+
+struct HeapSnapshot {
+    uint32_t freeHeap;
+    uint32_t maxBlock;
+};
+
+// 堆内存监测：定期采样空闲堆、最大连续块与碎片率，并记录开机以来的最差值
+class HeapMonitor {
+private:
+    uint32_t freeHeap;
+    uint32_t maxBlock;
+    uint8_t fragmentation;      // 0~100，ESP.getHeapFragmentation()
+    uint32_t minFreeHeap;
+    uint32_t minMaxBlock;
+    uint8_t maxFragmentation;
+    unsigned long lastSampleTime;
+    bool sampled;
+    HeapSnapshot stages[HEAP_STAGE_COUNT];
+
+public:
+    HeapMonitor();
+
+    // 在主循环中调用，按 HEAP_SAMPLE_INTERVAL_MS 间隔采样
+    void sample();
+
+    // 记录当前空闲堆与最大连续块，未记录的阶段输出 0
+    void mark(HeapStage stage);
+
+    void writeJson(Print &out) const;
+};
+
+#endif // HEAP_MONITOR_H
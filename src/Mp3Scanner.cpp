@@ -0,0 +1,213 @@
+#include "Mp3Scanner.h"
+#include <LittleFS.h>
+
+// Layer III 码率表（kbps），下标为帧头中的码率索引
+static const uint16_t BITRATE_MPEG1[16] PROGMEM = {
+    0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0
+};
+static const uint16_t BITRATE_MPEG2[16] PROGMEM = {
+    0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0
+};
+static const uint16_t SAMPLE_RATE_MPEG1[3] PROGMEM = {44100, 48000, 32000};
+
+// 解析 4 字节帧头，仅接受 Layer III；version: 0=MPEG2.5, 2=MPEG2, 3=MPEG1
+static bool parseFrameHeader(const uint8_t *h, uint8_t &version, uint32_t &sampleRate, uint16_t &kbps,
+                             uint16_t &frameLen, uint16_t &samplesPerFrame) {
+    if (h[0] != 0xFF || (h[1] & 0xE0) != 0xE0) {
+        return false;
+    }
+    version = (h[1] >> 3) & 0x03;
+    const uint8_t layer = (h[1] >> 1) & 0x03;
+    if (version == 1 || layer != 1) {
+        return false;
+    }
+    const uint8_t bitrateIndex = h[2] >> 4;
+    const uint8_t sampleRateIndex = (h[2] >> 2) & 0x03;
+    const uint8_t padding = (h[2] >> 1) & 0x01;
+    if (bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3) {
+        return false;
+    }
+    kbps = pgm_read_word(version == 3 ? &BITRATE_MPEG1[bitrateIndex] : &BITRATE_MPEG2[bitrateIndex]);
+    sampleRate = pgm_read_word(&SAMPLE_RATE_MPEG1[sampleRateIndex]);
+    if (version == 2) {
+        sampleRate /= 2;
+    } else if (version == 0) {
+        sampleRate /= 4;
+    }
+    samplesPerFrame = version == 3 ? 1152 : 576;
+    // 帧长 = 每帧采样数 / 8 * 码率 / 采样率 + 填充
+    frameLen = (uint16_t) ((uint32_t) (samplesPerFrame / 8) * kbps * 1000UL / sampleRate + padding);
+    return frameLen > 4;
+}
+
+Mp3Scanner::Mp3Scanner() {
+    reset();
+}
+
+void Mp3Scanner::reset() {
+    memset(&info, 0, sizeof(info));
+    info.indexStep = 1;
+    pos = 0;
+    skip = 0;
+    bitrateSum = 0;
+    hdrLen = 0;
+    version = 0;
+    tail = false;
+    err = nullptr;
+}
+
+void Mp3Scanner::addFrame(uint32_t offset, uint16_t frameLen, uint16_t kbps) {
+    if (info.frameCount % info.indexStep == 0) {
+        if (info.indexCount == MP3_INDEX_MAX) {
+            // 索引已满：保留偶数条目，步长翻倍
+            for (uint16_t i = 0; i < MP3_INDEX_MAX / 2; i++) {
+                offsets[i] = offsets[i * 2];
+            }
+            info.indexCount = MP3_INDEX_MAX / 2;
+            info.indexStep *= 2;
+        }
+        if (info.frameCount % info.indexStep == 0) {
+            offsets[info.indexCount++] = offset;
+        }
+    }
+    info.frameCount++;
+    bitrateSum += kbps;
+    info.dataEnd = offset + frameLen;
+}
+
+void Mp3Scanner::feed(const uint8_t *data, size_t len) {
+    while (len > 0 && err == nullptr && !tail) {
+        if (skip > 0) {
+            const uint32_t n = skip < len ? skip : (uint32_t) len;
+            skip -= n;
+            pos += n;
+            data += n;
+            len -= n;
+            continue;
+        }
+        hdr[hdrLen++] = *data++;
+        pos++;
+        len--;
+        if (hdrLen < 4) {
+            continue;
+        }
+        const uint32_t start = pos - hdrLen;
+        if (info.frameCount == 0 && hdr[0] == 'I' && hdr[1] == 'D' && hdr[2] == '3') {
+            if (hdrLen < 10) {
+                continue;
+            }
+            // ID3v2 长度为 syncsafe 整数，标志位 0x10 表示另有 10 字节尾部
+            skip = ((uint32_t) (hdr[6] & 0x7F) << 21) | ((uint32_t) (hdr[7] & 0x7F) << 14)
+                   | ((uint32_t) (hdr[8] & 0x7F) << 7) | (uint32_t) (hdr[9] & 0x7F);
+            if (hdr[5] & 0x10) {
+                skip += 10;
+            }
+            hdrLen = 0;
+            continue;
+        }
+        if (info.frameCount > 0 && hdr[0] == 'T' && hdr[1] == 'A' && hdr[2] == 'G') {
+            tail = true;
+            break;
+        }
+        uint8_t v;
+        uint32_t sampleRate;
+        uint16_t kbps;
+        uint16_t frameLen;
+        uint16_t samplesPerFrame;
+        if (parseFrameHeader(hdr, v, sampleRate, kbps, frameLen, samplesPerFrame)
+            && (info.frameCount == 0 || (v == version && sampleRate == info.sampleRate))) {
+            if (info.frameCount == 0) {
+                version = v;
+                info.sampleRate = sampleRate;
+                info.samplesPerFrame = samplesPerFrame;
+                info.dataOffset = start;
+            }
+            addFrame(start, frameLen, kbps);
+            skip = frameLen - 4;
+            hdrLen = 0;
+        } else {
+            // 不是合法帧头：滑动一个字节继续寻找同步字
+            memmove(hdr, hdr + 1, hdrLen - 1);
+            hdrLen--;
+        }
+    }
+    pos += len;
+}
+
+bool Mp3Scanner::finish() {
+    info.magic = MP3_INDEX_MAGIC;
+    if (err != nullptr) {
+        return false;
+    }
+    if (info.frameCount == 0) {
+        err = "未找到有效的 MP3 帧";
+        return false;
+    }
+    // 末帧被截断时以实际数据结尾为准
+    if (info.dataEnd > pos) {
+        info.dataEnd = pos;
+    }
+    info.bitrateKbps = (uint16_t) (bitrateSum / info.frameCount);
+    info.durationMs = (uint32_t) ((uint64_t) info.frameCount * info.samplesPerFrame * 1000ULL / info.sampleRate);
+    if (info.sampleRate > MP3_MAX_SAMPLE_RATE) {
+        err = "采样率不受支持";
+    } else if (info.bitrateKbps > MP3_MAX_BITRATE_KBPS) {
+        err = "码率过高，最大 192kbps";
+    } else if (info.durationMs > MP3_MAX_DURATION_MS) {
+        err = "时长超过限制（最大 5 秒）";
+    }
+    return err == nullptr;
+}
+
+const char *Mp3Scanner::getError() const {
+    return err != nullptr ? err : "";
+}
+
+const Mp3IndexHeader &Mp3Scanner::getInfo() const {
+    return info;
+}
+
+bool Mp3Scanner::saveIndex(const String &path) const {
+    File f = LittleFS.open(path, "w");
+    if (!f) {
+        return false;
+    }
+    const size_t offsetsSize = info.indexCount * sizeof(uint32_t);
+    bool ok = f.write((const uint8_t *) &info, sizeof(info)) == sizeof(info);
+    ok = ok && f.write((const uint8_t *) offsets, offsetsSize) == offsetsSize;
+    f.close();
+    return ok;
+}
+
+bool Mp3Scanner::loadIndex(const String &path, Mp3IndexHeader &out) {
+    File f = LittleFS.open(path, "r");
+    if (!f) {
+        return false;
+    }
+    const size_t n = f.read((uint8_t *) &out, sizeof(out));
+    f.close();
+    return n == sizeof(out) && out.magic == MP3_INDEX_MAGIC && out.dataEnd > out.dataOffset;
+}
+
+bool Mp3Scanner::buildIndex(const String &audioPath, Mp3IndexHeader &out) {
+    File f = LittleFS.open(audioPath, "r");
+    if (!f) {
+        return false;
+    }
+    Mp3Scanner scanner;
+    uint8_t chunk[256];
+    size_t n;
+    while ((n = f.read(chunk, sizeof(chunk))) > 0) {
+        scanner.feed(chunk, n);
+    }
+    f.close();
+    if (!scanner.finish() || !scanner.saveIndex(indexPathFor(audioPath))) {
+        return false;
+    }
+    out = scanner.getInfo();
+    return true;
+}
+
+String Mp3Scanner::indexPathFor(const String &audioPath) {
+    return audioPath + ".idx";
+}
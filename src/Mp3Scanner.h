@@ -0,0 +1,66 @@
+#ifndef MP3_SCANNER_H
+#define MP3_SCANNER_H
+
+#include <Arduino.h>
+
+#define MP3_INDEX_MAGIC 0x5849334DUL // "M3IX"
+#define MP3_INDEX_MAX 32             // 帧偏移索引最多条目数
+#define MP3_MAX_BITRATE_KBPS 192     // ESP8266 在雷达主循环内可稳定解码的最高码率
+#define MP3_MAX_SAMPLE_RATE 48000
+#define MP3_MAX_DURATION_MS 5000     // 与网页端限制一致
+
+// 音效旁路索引文件（<音效路径>.idx）的头部，上传时生成，播放时据此跳过标签并精确结束
+struct Mp3IndexHeader {
+    uint32_t magic;
+    uint32_t sampleRate;
+    uint32_t dataOffset;      // 首帧偏移（已跳过 ID3v2）
+    uint32_t dataEnd;         // 末帧结束位置（不含 ID3v1）
+    uint32_t frameCount;
+    uint32_t durationMs;
+    uint16_t bitrateKbps;     // 平均码率
+    uint16_t samplesPerFrame;
+    uint16_t indexStep;       // 每隔多少帧记录一个偏移
+    uint16_t indexCount;
+};
+
+// 流式 MP3 帧头解析：上传分块到达时逐块喂入，无需缓存整个文件
+class Mp3Scanner {
+private:
+    Mp3IndexHeader info;
+    uint32_t offsets[MP3_INDEX_MAX];
+    uint32_t pos;           // 已处理的字节数
+    uint32_t skip;          // 待跳过的字节数（ID3 标签或当前帧剩余部分）
+    uint32_t bitrateSum;
+    uint8_t hdr[10];        // 跨分块拼接的头部字节
+    uint8_t hdrLen;
+    uint8_t version;        // 首帧的 MPEG 版本位，后续帧必须一致
+    bool tail;              // 已遇到 ID3v1 标签，其后数据忽略
+    const char *err;
+
+    void addFrame(uint32_t offset, uint16_t frameLen, uint16_t kbps);
+
+public:
+    Mp3Scanner();
+
+    void reset();
+
+    void feed(const uint8_t *data, size_t len);
+
+    // 结束解析并校验采样率、码率、时长，失败时 getError() 返回原因
+    bool finish();
+
+    const char *getError() const;
+
+    const Mp3IndexHeader &getInfo() const;
+
+    bool saveIndex(const String &path) const;
+
+    static bool loadIndex(const String &path, Mp3IndexHeader &out);
+
+    // 扫描已存在的音效文件并生成旁路索引（用于随文件系统镜像烧录、尚无索引的音效）
+    static bool buildIndex(const String &audioPath, Mp3IndexHeader &out);
+
+    static String indexPathFor(const String &audioPath);
+};
+
+#endif // MP3_SCANNER_H
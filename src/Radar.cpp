@@ -1,28 +1,82 @@
 #include "Radar.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include <stdarg.h>
 static const size_t RADAR_LOG_MAX_SIZE = 32768; // 32KB 最大日志大小
+static const size_t LOG_LINE_MAX = 192; // 单行日志上限（含时间戳）
+static const unsigned long LOG_FLUSH_INTERVAL_MS = 500; // 间隔达到该时间触发落盘
+static const unsigned long TONE_HOLD_MS = 1500; // 合成音在最后一次目标刷新后继续鸣响的时长
+static const unsigned long TONE_CONTINUOUS_TTC_MS = 1000; // 预计碰撞时间低于该值时改为连续音
+static const unsigned long AUDIO_END_MARGIN_MS = 200; // 有帧索引时在精确时长上预留的输出缓冲排空时间
+
+// 预计碰撞时间（毫秒）= 距离(m) / 速度(km/h) * 3600，调用方保证速度大于 0
+static inline unsigned long timeToContactMs(const RadarTarget &target) {
+    return (unsigned long) target.distance * 3600UL / target.speed;
+}
+// 雷达接线：LD2451 上电后自动上报，只需接 RX。多雷达时正后方不再接 TX，D6 改作左侧 RX
+struct RadarSensorWiring {
+    int8_t rxPin;
+    int8_t txPin;
+    int8_t mountAngle;  // 负值偏左
+};
+static_assert(RADAR_SENSOR_COUNT >= 1 && RADAR_SENSOR_COUNT <= 3, "RADAR_SENSOR_COUNT 取值 1~3");
+static const RadarSensorWiring RADAR_SENSOR_WIRING[RADAR_SENSOR_COUNT] = {
+#if RADAR_SENSOR_COUNT == 1
+    {D5, D6, 0},                        // 正后方
+#else
+    {D5, -1, 0},                        // 正后方
+    {D6, -1, -RADAR_SIDE_MOUNT_DEG},    // 左后方
+#if RADAR_SENSOR_COUNT > 2
+    {D3, -1, RADAR_SIDE_MOUNT_DEG},     // 右后方（GPIO0：雷达 TX 空闲为高电平，不影响启动）
+#endif
+#endif
+};
 
 Radar::Radar(ConfigManager *config) {
     configMgr = config;
-    radarSerial = new SoftwareSerial(D5, D6);
-    bufferIndex = 0;
+    for (uint8_t i = 0; i < RADAR_SENSOR_COUNT; i++) {
+        const RadarSensorWiring &w = RADAR_SENSOR_WIRING[i];
+        sensors[i].attach(i, w.rxPin, w.txPin, w.mountAngle);
+    }
+#if RADAR_FEATURE_AUDIO
     mp3 = nullptr;
-    file = nullptr;
+    mp3Arena = nullptr;
+    player = nullptr;
     out = nullptr;
+    source = nullptr;
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        audioIndexValid[i] = false;
+        audioAsset[i] = -1;
+    }
+#endif
+#if RADAR_FEATURE_LOG
+    logFill = 0;
+    lastLogFlush = 0;
+#endif
+    memset(&frameCycles, 0, sizeof(frameCycles));
 }
 
 void Radar::begin() {
     delay(100);
-    radarSerial->begin(115200);
+    for (uint8_t i = 0; i < RADAR_SENSOR_COUNT; i++) {
+        sensors[i].begin();
+    }
     const auto &cfg = configMgr->getConfig();
+#if RADAR_FEATURE_AUDIO
     if (cfg.audioEnabled) {
+        // 音频对象只在启动时创建一次，运行期间不再释放
         if (cfg.audioI2S) {
             out = new AudioOutputI2S();
         } else {
             out = new AudioOutputI2SNoDAC();
         }
+        if (!cfg.audioSynth) {
+            mp3 = new AudioGeneratorMP3();
+            reserveAudioArena();
+            reloadAudioIndex();
+        }
     }
+#endif
     delay(200);
     pinMode(LEFT_LIGHT_PIN, OUTPUT);
     digitalWrite(LEFT_LIGHT_PIN, LOW);
@@ -34,16 +88,45 @@ void Radar::begin() {
     digitalWrite(REAR_LIGHT_PIN, HIGH);
     delay(2000);
     digitalWrite(REAR_LIGHT_PIN, LOW);
-    if (cfg.audioEnabled && cfg.startAudio) {
-        playAudio("/start.mp3");
+    stats.begin();
+    if (cfg.trackEnabled) {
+        rideRecorder.begin();
+    }
+    // 链路检测从此刻起计时，启动期间的等待不算静默
+    for (uint8_t i = 0; i < RADAR_SENSOR_COUNT; i++) {
+        linkHealth[i].begin(millis());
+    }
+    if (FEATURE_AUDIO && cfg.audioEnabled && cfg.startAudio) {
+        if (cfg.audioSynth) {
+            playTone(1200, 300, 300, true, 300);
+        } else {
+            playAlert(ALERT_START);
+        }
     }
 }
 
+#if RADAR_FEATURE_TELEMETRY
+void Radar::setTelemetry(Telemetry *t) {
+    telemetry = t;
+}
+#endif
+
+void Radar::setWatchdog(StallWatchdog *w) {
+    watchdog = w;
+}
+
+void Radar::setAssetStore(const AssetStore *a) {
+    assets = a;
+}
+
 void Radar::triggerLightWarning(bool left, bool right, bool isDanger) {
-    const auto &cfg = configMgr->getConfig();
-    if (cfg.lightBlink) {
-        blinkInterval = (unsigned long) (isDanger ? cfg.dangerBlinkInterval : cfg.normalBlinkInterval);
+    const RideProfileState &profile = configMgr->getProfileState();
+    alertDanger = isDanger;
+    if (profile.lightBlink) {
+        blinkInterval = profile.blinkIntervalMs[isDanger ? 1 : 0];
     }
+    // 预警优先于档位提示
+    indicatorSteps = 0;
     const unsigned long now = millis();
     if (left) {
         leftLightOn = true;
@@ -63,78 +146,345 @@ void Radar::triggerLightWarning(bool left, bool right, bool isDanger) {
     }
 }
 
-bool Radar::playAudio(String audio) {
-    if (mp3 == nullptr) {
-        mp3 = new AudioGeneratorMP3();
+#if RADAR_FEATURE_AUDIO
+void Radar::serviceAudio() {
+    if (player == nullptr) {
+        return;
     }
-    if (mp3->isRunning()) {
+    bool needStop = false;
+    if (player->isRunning()) {
+        if (!player->loop()) {
+            needStop = true;
+        } else {
+            unsigned long maxMs = currentMaxAudioMs > 0 ? currentMaxAudioMs : 1000UL;
+            if (millis() - audioStartTime > maxMs) {
+                needStop = true;
+            }
+        }
+        yield();
+    } else {
+        needStop = true;
+    }
+    if (needStop) {
+        stopAudioAndResetLights();
+    }
+}
+
+void Radar::stopPlayer() {
+    if (player != nullptr && player->isRunning()) {
+        player->stop();
+    }
+    if (source != nullptr && source->isOpen()) {
+        source->close();
+    }
+    source = nullptr;
+    currentAlert = ALERT_NONE;
+    indicatorBeep = false;
+}
+
+bool Radar::playAlert(AlertId alert) {
+    if (mp3 == nullptr || alert >= ALERT_COUNT) {
         return false;
     }
+    const AlertInfo &info = ALERT_CATALOG[alert];
+    if (player != nullptr && player->isRunning()) {
+        // 档位提示音可被任何音效打断；其余只允许更高优先级的音效（如危险预警）打断
+        if (!indicatorBeep && (currentAlert == ALERT_NONE || info.priority <= ALERT_CATALOG[currentAlert].priority)) {
+            return false;
+        }
+        stopPlayer();
+    }
     const auto &cfg = configMgr->getConfig();
-    file = new AudioFileSourceLittleFS(audio.c_str());
+    StallPhaseScope phaseScope(watchdog, PHASE_AUDIO_START);
+    const unsigned long startUs = micros();
+    const Mp3IndexHeader *index = audioIndexValid[alert] ? &audioIndex[alert] : nullptr;
+    // 复用同一个音频源对象：内置音效只记录闪存偏移，上传的音效重新打开文件
+    const bool fromFlash = audioAsset[alert] >= 0;
+    if (fromFlash) {
+        assetFile.open(assets, (uint8_t) audioAsset[alert]);
+        source = &assetFile;
+    } else {
+        file.open(info.path);
+        source = &file;
+    }
+    if (index != nullptr) {
+        // 跳过 ID3 标签直接从首帧解码，末帧后即结束
+        if (fromFlash) {
+            assetFile.setRange(index->dataOffset, index->dataEnd);
+        } else {
+            file.setRange(index->dataOffset, index->dataEnd);
+        }
+    }
     out->SetGain(cfg.warningGain);
-    bool ok = mp3->begin(file, out);
+    bool ok = mp3->begin(source, out);
     if (ok) {
+        player = mp3;
+        currentAlert = alert;
         audioStartTime = millis();
-        currentMaxAudioMs = getMaxAudioMsForPath(audio);
+        currentMaxAudioMs = index != nullptr ? index->durationMs + AUDIO_END_MARGIN_MS : getMaxAudioMs(alert);
+    }
+    if (!ok) {
+        source->close();
+        source = nullptr;
+    }
+    if (FEATURE_LOG && cfg.logEnabled) {
+        writeLog("[audio] 启动 %s 耗时 %luus, 索引=%d, 闪存=%d, ok=%d", info.path, (unsigned long) (micros() - startUs),
+                 index != nullptr ? 1 : 0, fromFlash ? 1 : 0, ok ? 1 : 0);
     }
     return ok;
 }
 
+// 内置音效直接从闪存扫描帧头生成索引，只保存在内存中
+static bool scanAssetIndex(const AssetStore &assets, uint8_t asset, Mp3IndexHeader &out) {
+    Mp3Scanner scanner;
+    uint8_t chunk[256];
+    const uint32_t size = assets.get(asset).size;
+    for (uint32_t pos = 0; pos < size; pos += sizeof(chunk)) {
+        scanner.feed(chunk, assets.read(asset, pos, chunk, sizeof(chunk)));
+    }
+    if (!scanner.finish()) {
+        return false;
+    }
+    out = scanner.getInfo();
+    return true;
+}
+
+void Radar::reloadAudioIndex() {
+    for (uint8_t i = 0; i < ALERT_COUNT; i++) {
+        audioAsset[i] = assets != nullptr ? assets->find(ALERT_CATALOG[i].path) : -1;
+        if (audioAsset[i] >= 0) {
+            audioIndexValid[i] = scanAssetIndex(*assets, (uint8_t) audioAsset[i], audioIndex[i]);
+            continue;
+        }
+        const String path = ALERT_CATALOG[i].path;
+        audioIndexValid[i] = Mp3Scanner::loadIndex(Mp3Scanner::indexPathFor(path), audioIndex[i])
+                             || Mp3Scanner::buildIndex(path, audioIndex[i]);
+    }
+}
 
-void Radar::triggerAudioWarning(bool left, bool right, bool isDanger) {
+bool Radar::playTone(uint16_t freqHz, uint16_t periodMs, uint16_t onMs, bool chirpOn, unsigned long maxMs) {
+    if (out == nullptr) {
+        return false;
+    }
+    if (player != nullptr && player->isRunning()) {
+        if (!indicatorBeep) {
+            return false;
+        }
+        stopPlayer();
+    }
     const auto &cfg = configMgr->getConfig();
-    String path;
+    out->SetGain(cfg.warningGain);
+    tone.setCadence(freqHz, periodMs, onMs, chirpOn);
+    tone.setDuration(maxMs);
+    bool ok = tone.begin(nullptr, out);
+    if (ok) {
+        player = &tone;
+        currentAlert = ALERT_NONE;
+        audioStartTime = millis();
+        currentMaxAudioMs = maxMs;
+    }
+    return ok;
+}
+
+bool Radar::playSynthPreset(bool directional, bool isDanger) {
     if (isDanger) {
-        path = "/danger.mp3";
-    } else {
-        if (cfg.lightAngle) {
-            if (left && right) {
-                path = "/rear.mp3"; // 正后方来车
-            } else if (left) {
-                path = "/left.mp3"; // 左后方来车
-            } else if (right) {
-                path = "/right.mp3"; // 右后方来车
-            }
+        return playTone(2000, 150, 90, true, TONE_HOLD_MS);
+    }
+    if (directional) {
+        return playTone(1400, 400, 200, false, TONE_HOLD_MS);
+    }
+    return playTone(1000, 600, 300, false, TONE_HOLD_MS);
+}
+
+void Radar::updateToneThreat(const RadarTarget &target, bool isDanger) {
+    // 只在合成音播放中刷新
+    if (player != &tone || !tone.isRunning()) {
+        return;
+    }
+    const unsigned long ttcMs = timeToContactMs(target);
+    // 类似倒车雷达：越近越急促、音调越高
+    unsigned long periodMs = ttcMs / 8;
+    if (periodMs < 100) {
+        periodMs = 100;
+    } else if (periodMs > 1000) {
+        periodMs = 1000;
+    }
+    const uint16_t freqHz = (uint16_t) (800 + (1000 - periodMs) * 3 / 2);
+    const uint16_t onMs = (uint16_t) (ttcMs < TONE_CONTINUOUS_TTC_MS ? periodMs : periodMs / 2);
+    tone.setCadence(freqHz, (uint16_t) periodMs, onMs, isDanger);
+    tone.setDuration(0);
+    // 每次刷新都顺延停止时间，目标持续存在时不中断
+    audioStartTime = millis();
+    currentMaxAudioMs = TONE_HOLD_MS;
+}
+
+
+void Radar::triggerAudioWarning(bool left, bool right, bool isDanger, const RadarTarget &target) {
+    const auto &cfg = configMgr->getConfig();
+    if (cfg.audioSynth) {
+        // 合成音正在播放时只刷新节奏，不重新开始；档位提示音直接被预警音替换
+        const bool playing = (player == &tone && tone.isRunning() && !indicatorBeep)
+                             || playSynthPreset(cfg.lightAngle && !(left && right), isDanger);
+        if (playing) {
+            updateToneThreat(target, isDanger);
+        }
+        triggerLightWarning(left, right, isDanger);
+        return;
+    }
+    AlertId alert = ALERT_NORMAL;
+    if (isDanger) {
+        alert = ALERT_DANGER;
+    } else if (cfg.lightAngle) {
+        if (left && right) {
+            alert = ALERT_REAR; // 正后方来车
+        } else if (left) {
+            alert = ALERT_LEFT; // 左后方来车
         } else {
-            path = "/normal.mp3";
+            alert = ALERT_RIGHT; // 右后方来车
         }
     }
-    if (playAudio(path)) {
-        triggerLightWarning(left, right, isDanger);
+    // 音效未能启动（更高优先级的音效播放中或文件缺失）时灯光照常预警
+    playAlert(alert);
+    triggerLightWarning(left, right, isDanger);
+}
+
+void Radar::stopAudioAndResetLights() {
+    stopPlayer();
+    audioStartTime = 0;
+    currentMaxAudioMs = 0;
+    leftLightOn = false;
+    rightLightOn = false;
+    leftLightPinState = false;
+    rightLightPinState = false;
+    digitalWrite(LEFT_LIGHT_PIN, LOW);
+    digitalWrite(RIGHT_LIGHT_PIN, LOW);
+    digitalWrite(REAR_LIGHT_PIN, LOW);
+    const auto &cfg = configMgr->getConfig();
+    if (FEATURE_LOG && cfg.logEnabled && hasLastTarget) {
+        writeLog("[audio] 结束播放，灯光复位，目标 dist=%u，speed=%u，angle=%d，ts=%lu", lastTarget.distance,
+                 lastTarget.speed, lastTarget.angle, lastTarget.timestamp);
+    }
+}
+
+unsigned long Radar::getMaxAudioMs(AlertId alert) const {
+    const auto &cfg = configMgr->getConfig();
+    return cfg.audioDurationMs[alert] ? cfg.audioDurationMs[alert] : ALERT_CATALOG[alert].defaultDurationMs;
+}
+
+bool Radar::isAudioBusy() const {
+    return player != nullptr && player->isRunning();
+}
+
+// MP3 解码缓冲只要放得下就整块预留并常驻：每次预警 begin/stop 时反复 malloc/free 约 29KB，
+// 其间分配的小块（遥测发包缓冲、文件句柄）会落在解码缓冲之间，释放后把堆切碎，之后的预警因找不到连续块而无法解码
+bool Radar::reserveAudioArena() {
+    if (mp3 == nullptr || mp3Arena != nullptr) {
+        return mp3Arena != nullptr;
+    }
+    const uint32_t arenaSize = AudioGeneratorMP3::preAllocSize();
+    void *arena = malloc(arenaSize);
+    if (arena == nullptr) {
+        return false;
+    }
+    if (player == mp3) {
+        stopPlayer();
+        player = nullptr;
+    }
+    delete mp3;
+    mp3Arena = arena;
+    mp3 = new AudioGeneratorMP3(mp3Arena, arenaSize);
+    return true;
+}
+
+void Radar::releaseAudioArena() {
+    if (mp3Arena == nullptr) {
+        return;
     }
+    if (player == mp3) {
+        stopPlayer();
+        player = nullptr;
+    }
+    delete mp3;
+    free(mp3Arena);
+    mp3Arena = nullptr;
+    mp3 = new AudioGeneratorMP3();
+}
+#else
+bool Radar::playAlert(AlertId alert) {
+    (void) alert;
+    return false;
+}
+
+void Radar::reloadAudioIndex() {
+}
+
+bool Radar::reserveAudioArena() {
+    return false;
+}
+
+void Radar::releaseAudioArena() {
+}
+
+bool Radar::playTone(uint16_t freqHz, uint16_t periodMs, uint16_t onMs, bool chirpOn, unsigned long maxMs) {
+    (void) freqHz;
+    (void) periodMs;
+    (void) onMs;
+    (void) chirpOn;
+    (void) maxMs;
+    return false;
 }
 
-void Radar::testFunction(String function) {
-    String path;
-    bool isDanger = true;
+bool Radar::playSynthPreset(bool directional, bool isDanger) {
+    (void) directional;
+    (void) isDanger;
+    return false;
+}
+
+void Radar::updateToneThreat(const RadarTarget &target, bool isDanger) {
+    (void) target;
+    (void) isDanger;
+}
+
+void Radar::triggerAudioWarning(bool left, bool right, bool isDanger, const RadarTarget &target) {
+    (void) target;
+    triggerLightWarning(left, right, isDanger);
+}
+
+bool Radar::isAudioBusy() const {
+    return false;
+}
+#endif // RADAR_FEATURE_AUDIO
+
+void Radar::testFunction(AlertId alert) {
+    bool isDanger = alert != ALERT_NORMAL;
     bool left = false;
     bool right = false;
-    if (function == "left") {
-        path = "/left.mp3";
-        left = true;
-    } else if (function == "right") {
-        path = "/right.mp3";
-        right = true;
-    } else if (function == "rear") {
-        path = "/rear.mp3";
-        left = true;
-        right = true;
-    } else if (function == "danger") {
-        path = "/danger.mp3";
-        left = true;
-        right = true;
-    } else if (function == "normal") {
-        path = "/normal.mp3";
-        left = true;
-        right = true;
-        isDanger = false;
-    } else if (function == "start") {
-        path = "/start.mp3";
+    switch (alert) {
+        case ALERT_LEFT:
+            left = true;
+            break;
+        case ALERT_RIGHT:
+            right = true;
+            break;
+        case ALERT_NORMAL:
+        case ALERT_DANGER:
+        case ALERT_REAR:
+            left = true;
+            right = true;
+            break;
+        default:
+            break;
     }
     const auto &cfg = configMgr->getConfig();
-    if (cfg.audioEnabled) {
-        if (playAudio(path)) {
+    if (FEATURE_AUDIO && cfg.audioEnabled) {
+        bool ok;
+        if (cfg.audioSynth) {
+            ok = alert == ALERT_START ? playTone(1200, 300, 300, true, 300)
+                                      : playSynthPreset(left != right, isDanger);
+        } else {
+            ok = playAlert(alert);
+        }
+        if (ok) {
             triggerLightWarning(left, right, isDanger);
         }
     } else {
@@ -142,38 +492,67 @@ void Radar::testFunction(String function) {
     }
 }
 
-void Radar::processTargets(uint8_t targetCount, uint8_t *data) {
+void Radar::processTargets(const RadarTarget *targets, uint8_t targetCount) {
     const auto &cfg = configMgr->getConfig();
+    // 阈值与方向取自当前档位预先计算的参数，双击切换档位后下一帧即生效
+    const RideProfileState &profile = configMgr->getProfileState();
     bool hasPreTarget = false;
     RadarTarget preTarget;
+    // 本帧最近的有效目标，写入骑行轨迹
+    bool hasNearest = false;
+    RadarTarget nearest;
+    // 本帧预计碰撞时间最短的有效目标，决定合成音的节奏与音高
+    bool hasUrgent = false;
+    bool urgentDanger = false;
+    unsigned long urgentTtcMs = 0;
+    RadarTarget urgent;
     const unsigned long now = millis();
+    //忽略不符目标（视场角已在各传感器按本地角度过滤）
+    RadarTarget valid[RADAR_SENSOR_COUNT * RADAR_MAX_TARGETS];
+    uint8_t validCount = 0;
     for (int i = 0; i < targetCount; i++) {
-        RadarTarget target = {
-            data[i * 5 + 2] == 0x01,
-            data[i * 5 + 1],
-            data[i * 5 + 3],
-            (int8_t) (data[i * 5] - 0x80),
-            now
-        };
-        //忽略不符目标
-        if (!target.approaching || target.distance <= 0 || target.distance > cfg.detectionDistance || target.speed <= 0
-            || target.speed < cfg.detectionSpeed || target.speed > 120 || target.angle <= -12 || target.angle >= 12) {
+        const RadarTarget &target = targets[i];
+        if (!target.approaching || target.distance <= 0 || target.distance > profile.detectionDistance
+            || target.speed <= 0 || target.speed < profile.detectionSpeed || target.speed > 120) {
+            continue;
+        }
+        valid[validCount++] = target;
+    }
+    // 杂波图从预警实际会处理的目标中学习，每轮新帧（包括无目标的帧）更新一次
+    clutter.observe(valid, validCount);
+    for (uint8_t i = 0; i < validCount; i++) {
+        const RadarTarget &target = valid[i];
+        // 杂波格中的目标在预警判断前丢弃，不记入统计与日志；达到危险速度的目标不抑制
+        if (cfg.clutterFilter && target.speed < profile.dangerSpeed && clutter.suppress(target)) {
             continue;
         }
+        const bool isDanger = (target.distance <= profile.dangerDistance) || (target.speed >= profile.dangerSpeed);
+        stats.recordApproach(target.distance);
+        if (!hasNearest || target.distance < nearest.distance) {
+            hasNearest = true;
+            nearest = target;
+        }
+        const unsigned long ttcMs = timeToContactMs(target);
+        if (!hasUrgent || ttcMs < urgentTtcMs) {
+            hasUrgent = true;
+            urgentTtcMs = ttcMs;
+            urgent = target;
+            urgentDanger = isDanger;
+        }
         // 与前一个目标比较，如果完全一致则忽略
-        if (targetCount > 1 && hasPreTarget && target.distance == preTarget.distance && target.speed == preTarget.speed
+        if (validCount > 1 && hasPreTarget && target.distance == preTarget.distance && target.speed == preTarget.speed
             && target.angle == preTarget.angle) {
-            if (cfg.logEnabled) {
-                writeLog(String(millis()) + " [target] 与前一目标重复，忽略: dist=" + target.distance +
-                         ", speed=" + target.speed + ", angle=" + (int) target.angle + ", ts=" + target.timestamp);
+            if (FEATURE_LOG && cfg.logEnabled) {
+                writeLog("[target] 与前一目标重复，忽略: dist=%u, speed=%u, angle=%d, ts=%lu", target.distance,
+                         target.speed, target.angle, target.timestamp);
             }
             continue;
         }
         if (hasLastTarget && ((lastTarget.distance == target.distance && lastTarget.speed == target.speed && lastTarget.
                                angle == target.angle) || (now - lastTarget.timestamp) < 1000UL)) {
-            if (cfg.logEnabled) {
-                writeLog(String(millis()) + " [target] 与最近目标重复或时间过近，忽略: dist=" + target.distance +
-                         ", speed=" + target.speed + ", angle=" + (int) target.angle + ", ts=" + target.timestamp);
+            if (FEATURE_LOG && cfg.logEnabled) {
+                writeLog("[target] 与最近目标重复或时间过近，忽略: dist=%u, speed=%u, angle=%d, ts=%lu",
+                         target.distance, target.speed, target.angle, target.timestamp);
             }
             continue;
         }
@@ -181,86 +560,170 @@ void Radar::processTargets(uint8_t targetCount, uint8_t *data) {
         preTarget = target;
         hasLastTarget = true;
         lastTarget = target;
-        const bool isDanger = (target.distance <= cfg.dangerDistance) || (target.speed >= cfg.dangerSpeed);
-        // 根据角度区分方向：左后方、右后方、正后方
-        const int8_t centerAngle = (int8_t) cfg.centerAngle; // 中心阈值（±centerAngle° 视为正后方）
-        bool left = false;
-        bool right = false;
-        if (!cfg.lightAngle) {
-            left = true;
-            right = true;
-        } else {
-            if (target.angle <= -centerAngle) {
-                left = true;
-            } else if (target.angle >= centerAngle) {
-                right = true;
-            } else {
-                left = true;
-                right = true;
-            }
-        }
-        if (cfg.audioEnabled) {
-            triggerAudioWarning(left, right, isDanger);
-            if (cfg.logEnabled) {
-                writeLog(
-                    String(millis()) + " [warn] 触发预警: left=" + (left ? "1" : "0") + ", right=" + (right ? "1" : "0") +
-                    ", danger=" + (isDanger ? "1" : "0") + ", angle=" + (int) target.angle + ", dist=" + target.distance
-                    + ", speed=" + target.speed + ", ts=" + target.timestamp);
+        stats.recordTarget(target.distance, target.speed, target.angle, isDanger);
+        // 根据角度区分方向：左后方、右后方、正后方（不区分方向时左右同亮），查档位的方向表
+        const uint8_t dir = RideProfiles::direction(profile, target.angle);
+        const bool left = (dir & PROFILE_DIR_LEFT) != 0;
+        const bool right = (dir & PROFILE_DIR_RIGHT) != 0;
+        if (FEATURE_AUDIO && cfg.audioEnabled) {
+            triggerAudioWarning(left, right, isDanger, target);
+            if (FEATURE_LOG && cfg.logEnabled) {
+                writeLog("[warn] 触发预警: left=%d, right=%d, danger=%d, angle=%d, dist=%u, speed=%u, ts=%lu",
+                         left ? 1 : 0, right ? 1 : 0, isDanger ? 1 : 0, target.angle, target.distance, target.speed,
+                         target.timestamp);
             }
         } else {
             triggerLightWarning(left, right, isDanger);
-            if (cfg.logEnabled) {
-                writeLog(
-                    String(millis()) + " [light] 仅灯光预警: left=" + (left ? "1" : "0") + ", right=" + (right ? "1" : "0") +
-                    ", danger=" + (isDanger ? "1" : "0") + ", ts=" + target.timestamp);
+            if (FEATURE_LOG && cfg.logEnabled) {
+                writeLog("[light] 仅灯光预警: left=%d, right=%d, danger=%d, ts=%lu", left ? 1 : 0, right ? 1 : 0,
+                         isDanger ? 1 : 0, target.timestamp);
             }
         }
     }
+    // 合成音播放中：每帧按最紧急的目标刷新一次节奏与音高，不受上面的去重与时间间隔限制
+    if (FEATURE_AUDIO && hasUrgent && cfg.audioEnabled && cfg.audioSynth) {
+        updateToneThreat(urgent, urgentDanger);
+    }
+    if (hasNearest && cfg.trackEnabled) {
+        rideRecorder.recordFrame(nearest.distance, nearest.speed, nearest.angle);
+    }
 }
 
-bool Radar::parseRadarData() {
-    // 检查缓冲区是否有足够的数据
-    if (bufferIndex < 10) {
-        return false;
+void Radar::pollSensors() {
+    const uint32_t startCycles = ESP.getCycleCount();
+    const unsigned long now = millis();
+    uint8_t fusedCount = 0;
+    uint8_t sensorMask = 0;
+    // 每路只解析自己的新字节，总耗时随雷达数量线性增长
+    for (uint8_t i = 0; i < RADAR_SENSOR_COUNT; i++) {
+        uint8_t count;
+        if (sensors[i].poll(&fusedTargets[fusedCount], count, now)) {
+            fusedCount += count;
+            sensorMask |= 1 << i;
+        }
     }
-    // 查找帧头
-    for (int i = 0; i <= bufferIndex - 10; i++) {
-        if (buffer[i] == 0xF4 && buffer[i + 1] == 0xF3 && buffer[i + 2] == 0xF2 && buffer[i + 3] == 0xF1) {
-            // 找到帧头，检查是否有完整的帧
-            uint16_t dataLength = buffer[i + 4] | (buffer[i + 5] << 8);
-            // 检查是否有完整的帧（帧头4字节 + 长度2字节 + 数据长度 + 帧尾4字节）
-            if (i + 10 + dataLength <= bufferIndex) {
-                // 检查帧尾
-                int footerIndex = i + 6 + dataLength;
-                if (buffer[footerIndex] == 0xF8 && buffer[footerIndex + 1] == 0xF7 &&
-                    buffer[footerIndex + 2] == 0xF6 && buffer[footerIndex + 3] == 0xF5) {
-                    // 帧完整，处理数据
-                    uint8_t targetCount = buffer[i + 6]; // 目标数量
-                    // uint8_t alarmInfo = buffer[i + 7]; // 报警信息 (未使用)
-                    // 处理目标信息
-                    if (targetCount > 0) {
-                        processTargets(targetCount, &buffer[i + 8]);
-                    }
-                    // 移动缓冲区指针，丢弃已处理的数据
-                    int processedBytes = footerIndex + 4 - i;
-                    memmove(buffer, buffer + i + processedBytes, bufferIndex - i - processedBytes);
-                    bufferIndex -= processedBytes;
-                    return true;
-                }
-            }
+    checkLinks(now);
+    if (sensorMask != 0 && watchdog != nullptr) {
+        watchdog->noteFrame();
+    }
+    // 无目标的帧也要处理：杂波图按帧衰减
+    if (sensorMask != 0) {
+        processTargets(fusedTargets, fusedCount);
+    }
+    if (sensorMask != 0) {
+        const uint32_t cycles = ESP.getCycleCount() - startCycles;
+        frameCycles.frames++;
+        frameCycles.last = cycles;
+        frameCycles.sum += cycles;
+        if (cycles > frameCycles.max) {
+            frameCycles.max = cycles;
         }
     }
-    return false;
+#if RADAR_FEATURE_TELEMETRY
+    // 每轮新帧发送一包遥测，包含预警判断后的告警状态
+    if (sensorMask != 0 && telemetry != nullptr) {
+        uint8_t alert = 0;
+        if (leftLightOn) {
+            alert |= TELEMETRY_ALERT_LEFT;
+        }
+        if (rightLightOn) {
+            alert |= TELEMETRY_ALERT_RIGHT;
+        }
+        if ((leftLightOn || rightLightOn) && alertDanger) {
+            alert |= TELEMETRY_ALERT_DANGER;
+        }
+        if (isAudioBusy()) {
+            alert |= TELEMETRY_ALERT_AUDIO;
+        }
+        telemetry->sendFrame(fusedTargets, fusedCount, sensorMask, alert);
+    }
+#endif
+}
+
+void Radar::indicateProfile(uint8_t index) {
+    const auto &cfg = configMgr->getConfig();
+    const uint8_t count = index + 1;
+    // 第 N 档响 N 声、左右灯同时闪 N 次；播放中的预警音不被打断，只闪灯。提示音本身优先级最低
+#if RADAR_FEATURE_AUDIO
+    if (cfg.audioEnabled) {
+        indicatorBeep = playTone(1600, PROFILE_FLASH_MS * 2, PROFILE_FLASH_MS, false,
+                                 PROFILE_FLASH_MS * 2 * count - PROFILE_FLASH_MS);
+    }
+#else
+    (void) cfg;
+#endif
+    if (leftLightOn || rightLightOn) {
+        return;
+    }
+    indicatorSteps = count * 2;
+    indicatorLastStep = millis() - PROFILE_FLASH_MS;
+}
+
+void Radar::updateIndicator() {
+    const unsigned long now = millis();
+    if (now - indicatorLastStep < PROFILE_FLASH_MS) {
+        return;
+    }
+    indicatorLastStep = now;
+    indicatorSteps--;
+    // 剩余步数为奇数时点亮，最后一步熄灭
+    const uint8_t level = (indicatorSteps & 1) ? HIGH : LOW;
+    digitalWrite(LEFT_LIGHT_PIN, level);
+    digitalWrite(RIGHT_LIGHT_PIN, level);
+}
+
+void Radar::checkLinks(unsigned long now) {
+    const auto &cfg = configMgr->getConfig();
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < RADAR_SENSOR_COUNT; i++) {
+        RadarSensor &sensor = sensors[i];
+        const LinkAction action = linkHealth[i].update(sensor.getCounters(), now, (uint16_t) cfg.linkWindowMs,
+                                                       sensor.canRestart());
+        if (action == LINK_ACTION_REOPEN) {
+            sensor.reopen();
+        } else if (action == LINK_ACTION_RESTART) {
+            sensor.restartModule();
+        }
+        if (FEATURE_LOG && cfg.logEnabled && action != LINK_ACTION_NONE) {
+            writeLog("[link] 雷达%u 链路%s，%s", (unsigned) i, linkHealth[i].getState() == LINK_SILENT ? "静默" : "劣化",
+                     action == LINK_ACTION_RESTART ? "重启模块" : "重开串口");
+        }
+        if (linkHealth[i].isFaulted()) {
+            mask |= 1 << i;
+        }
+    }
+    linkFaultMask = mask;
+}
+
+void Radar::updateFaultLight() {
+    bool on = false;
+    if (linkFaultMask != 0) {
+        // 亮 100ms、灭 100ms、再亮 100ms，其余时间熄灭，区别于预警的常亮和匀速闪烁
+        const uint16_t phase = millis() % LINK_FAULT_PERIOD_MS;
+        on = phase < 100 || (phase >= 200 && phase < 300);
+    }
+    if (on != faultLightOn) {
+        faultLightOn = on;
+        digitalWrite(REAR_LIGHT_PIN, on ? HIGH : LOW);
+    }
 }
 
 void Radar::updateLightBehavior() {
     if (!leftLightOn && !rightLightOn) {
+        if (indicatorSteps > 0) {
+            updateIndicator();
+        }
+        updateFaultLight();
         return;
     }
+    // 预警期间尾灯归预警控制，结束时会被熄灭
+    faultLightOn = false;
     const auto &cfg = configMgr->getConfig();
-    const unsigned long durationMs = (unsigned long) cfg.blinkDuration * 1000UL;
+    const RideProfileState &profile = configMgr->getProfileState();
+    const unsigned long durationMs = profile.blinkDurationMs;
     const unsigned long now = millis();
-    if (!cfg.audioEnabled) {
+    // 有音频播放时灯光随音频结束熄灭，否则（关闭音频或音效未能启动）按持续时间熄灭
+    if (!(FEATURE_AUDIO && cfg.audioEnabled && isAudioBusy())) {
         if (now - leftLightOnTime >= durationMs) {
             leftLightOn = false;
             leftLightPinState = false;
@@ -278,14 +741,16 @@ void Radar::updateLightBehavior() {
         return;
     }
     // 闪烁模式的周期切换
-    if (cfg.lightBlink) {
+    if (profile.lightBlink) {
         if (leftLightOn && (now - leftLightLastBlinkTime >= blinkInterval)) {
             leftLightPinState = !leftLightPinState;
             digitalWrite(LEFT_LIGHT_PIN, leftLightPinState ? HIGH : LOW);
             digitalWrite(REAR_LIGHT_PIN, leftLightPinState ? HIGH : LOW);
             leftLightLastBlinkTime = now;
-            if (cfg.logEnabled && hasLastTarget) {
-                writeLog(String(millis()) + " [blink] 左灯切换 -> " + (leftLightPinState ? "HIGH" : "LOW") +"，目标 " +  (String("dist=") + lastTarget.distance + "，speed=" + lastTarget.speed +"，angle=" + (int) lastTarget.angle + "，ts=" + lastTarget.timestamp));
+            if (FEATURE_LOG && cfg.logEnabled && hasLastTarget) {
+                writeLog("[blink] 左灯切换 -> %s，目标 dist=%u，speed=%u，angle=%d，ts=%lu",
+                         leftLightPinState ? "HIGH" : "LOW", lastTarget.distance, lastTarget.speed, lastTarget.angle,
+                         lastTarget.timestamp);
             }
         }
         if (rightLightOn && (now - rightLightLastBlinkTime >= blinkInterval)) {
@@ -293,8 +758,10 @@ void Radar::updateLightBehavior() {
             digitalWrite(RIGHT_LIGHT_PIN, rightLightPinState ? HIGH : LOW);
             digitalWrite(REAR_LIGHT_PIN, rightLightPinState ? HIGH : LOW);
             rightLightLastBlinkTime = now;
-            if (cfg.logEnabled && hasLastTarget) {
-                writeLog(String(millis()) + " [blink] 右灯切换 -> " + (leftLightPinState ? "HIGH" : "LOW") +"，目标 " +  (String("dist=") + lastTarget.distance + "，speed=" + lastTarget.speed +"，angle=" + (int) lastTarget.angle + "，ts=" + lastTarget.timestamp));
+            if (FEATURE_LOG && cfg.logEnabled && hasLastTarget) {
+                writeLog("[blink] 右灯切换 -> %s，目标 dist=%u，speed=%u，angle=%d，ts=%lu",
+                         rightLightPinState ? "HIGH" : "LOW", lastTarget.distance, lastTarget.speed, lastTarget.angle,
+                         lastTarget.timestamp);
             }
         }
     }
@@ -302,103 +769,146 @@ void Radar::updateLightBehavior() {
 
 void Radar::warning() {
     const auto &cfg = configMgr->getConfig();
-    if (cfg.audioEnabled && mp3 != nullptr) {
-        bool needStop = false;
-        if (mp3->isRunning()) {
-            if (!mp3->loop()) {
-                needStop = true;
-            } else {
-                unsigned long maxMs = currentMaxAudioMs > 0 ? currentMaxAudioMs : 1000UL;
-                if (millis() - audioStartTime > maxMs) {
-                    needStop = true;
-                }
-            }
-            yield();
-        } else {
-            needStop = true;
-        }
-        if (needStop) {
-            stopAudioAndResetLights();
-        }
+#if RADAR_FEATURE_AUDIO
+    if (cfg.audioEnabled) {
+        enterPhase(PHASE_AUDIO);
+        serviceAudio();
     }
+#endif
     // 读取雷达数据
-    while (radarSerial->available()) {
-        buffer[bufferIndex] = radarSerial->read();
-        bufferIndex++;
-        // 防止缓冲区溢出
-        if ((unsigned int) bufferIndex >= sizeof(buffer)) {
-            bufferIndex = 0;
-        }
-        if (parseRadarData()) {
-            // 数据解析成功，重置缓冲区
-            bufferIndex = 0;
-            yield();
-        }
-    }
+    enterPhase(PHASE_SENSORS);
+    pollSensors();
+    enterPhase(PHASE_LIGHTS);
     updateLightBehavior();
+    // 统计数据只在没有音频播放时落盘，避免文件写入打断解码
+    const bool audioIdle = !isAudioBusy();
+    enterPhase(PHASE_STATS);
+    stats.loop(audioIdle);
+    if (cfg.trackEnabled) {
+        enterPhase(PHASE_RIDES);
+        rideRecorder.loop(audioIdle);
+    }
 }
 
-void Radar::stopAudioAndResetLights() {
-    if (mp3 != nullptr && mp3->isRunning()) {
-        mp3->stop();
-    }
-    if (file != nullptr) {
-        file->close();
-        delete file;
-        file = nullptr;
-    }
-    audioStartTime = 0;
-    currentMaxAudioMs = 0;
-    leftLightOn = false;
-    rightLightOn = false;
-    leftLightPinState = false;
-    rightLightPinState = false;
-    digitalWrite(LEFT_LIGHT_PIN, LOW);
-    digitalWrite(RIGHT_LIGHT_PIN, LOW);
-    digitalWrite(REAR_LIGHT_PIN, LOW);
-    const auto &cfg = configMgr->getConfig();
-    if (cfg.logEnabled && hasLastTarget) {
-        unsigned long __now = millis();
-        writeLog(String(__now) + " [audio] 结束播放，灯光复位，目标 " +( (String("dist=") + lastTarget.distance + "，speed=" + lastTarget.speed +"，angle=" + (int) lastTarget.angle + "，ts=" + lastTarget.timestamp)));
+const TrafficStats &Radar::getStats() const {
+    return stats;
+}
+
+void Radar::resetStats() {
+    stats.reset();
+}
+
+const ClutterMap &Radar::getClutterMap() const {
+    return clutter;
+}
+
+void Radar::resetClutterMap() {
+    clutter.reset();
+}
+
+uint8_t Radar::getSensorCount() const {
+    return RADAR_SENSOR_COUNT;
+}
+
+const RadarSensor &Radar::getSensor(uint8_t index) const {
+    return sensors[index];
+}
+
+const RadarLinkHealth &Radar::getLinkHealth(uint8_t index) const {
+    return linkHealth[index];
+}
+
+const FrameCycleStats &Radar::getFrameCycles() const {
+    return frameCycles;
+}
+
+void Radar::writeProfileJson(Print &out) const {
+    out.print("{\"profile\":\"");
+    out.print(RADAR_PROFILE);
+    out.print("\",\"audio\":");
+    out.print(FEATURE_AUDIO ? "true" : "false");
+    out.print(",\"web\":");
+    out.print(FEATURE_WEB ? "true" : "false");
+    out.print(",\"log\":");
+    out.print(FEATURE_LOG ? "true" : "false");
+    out.print(",\"telemetry\":");
+    out.print(FEATURE_TELEMETRY ? "true" : "false");
+    out.print(",\"sensors\":");
+    out.print(RADAR_SENSOR_COUNT);
+    out.print(",\"cpuMHz\":");
+    out.print(ESP.getCpuFreqMHz());
+    out.print(",\"frames\":");
+    out.print(frameCycles.frames);
+    out.print(",\"frameCyclesLast\":");
+    out.print(frameCycles.last);
+    out.print(",\"frameCyclesAvg\":");
+    out.print(frameCycles.frames > 0 ? (uint32_t) (frameCycles.sum / frameCycles.frames) : 0);
+    out.print(",\"frameCyclesMax\":");
+    out.print(frameCycles.max);
+    out.print('}');
+}
+
+void Radar::writeSensorJson(Print &out) const {
+    out.print('[');
+    for (uint8_t i = 0; i < RADAR_SENSOR_COUNT; i++) {
+        const RadarSensorCounters &c = sensors[i].getCounters();
+        if (i > 0) {
+            out.print(',');
+        }
+        out.print("{\"id\":");
+        out.print(i);
+        out.print(",\"mountAngle\":");
+        out.print(sensors[i].getMountAngle());
+        out.print(",\"bytes\":");
+        out.print(c.bytes);
+        out.print(",\"frames\":");
+        out.print(c.frames);
+        out.print(",\"badFrames\":");
+        out.print(c.badFrames);
+        out.print(",\"overflows\":");
+        out.print(c.overflows);
+        out.print(",\"resyncs\":");
+        out.print(c.resyncs);
+        out.print(",\"lastFrameAgoMs\":");
+        out.print(c.frames > 0 ? (long) (millis() - c.lastFrameMs) : -1L);
+        out.print(",\"link\":");
+        linkHealth[i].writeJson(out, millis());
+        out.print('}');
     }
+    out.print(']');
 }
 
-unsigned long Radar::getMaxAudioMsForPath(const String &path) {
-    const auto &cfg = configMgr->getConfig();
-    if (path.endsWith("/normal.mp3") || path == "/normal.mp3") {
-        return cfg.audioDurationMsNormal ? cfg.audioDurationMsNormal : 2000UL;
-    } else if (path.endsWith("/danger.mp3") || path == "/danger.mp3") {
-        return cfg.audioDurationMsDanger ? cfg.audioDurationMsDanger : 1000UL;
-    } else if (path.endsWith("/left.mp3") || path == "/left.mp3") {
-        return cfg.audioDurationMsLeft ? cfg.audioDurationMsLeft : 1000UL;
-    } else if (path.endsWith("/right.mp3") || path == "/right.mp3") {
-        return cfg.audioDurationMsRight ? cfg.audioDurationMsRight : 1000UL;
-    } else if (path.endsWith("/rear.mp3") || path == "/rear.mp3") {
-        return cfg.audioDurationMsRear ? cfg.audioDurationMsRear : 1000UL;
-    } else if (path.endsWith("/start.mp3") || path == "/start.mp3") {
-        return cfg.audioDurationMsStart ? cfg.audioDurationMsStart : 1000UL;
-    }
-    // 默认其它文件 1000ms
-    return 1000UL;
-}
-
-void Radar::writeLog(const String &line) {
+#if RADAR_FEATURE_LOG
+void Radar::writeLog(const char *fmt, ...) {
     const auto &cfg = configMgr->getConfig();
     if (!cfg.logEnabled) return;
-    // 将日志行写入内存缓冲，并以阈值/时间间隔批量落盘，避免频繁文件写阻塞音频
-    static String s_buffer;
-    static unsigned long s_lastFlush = 0;
-    const size_t FLUSH_THRESHOLD_BYTES = 2048; // 累计达到该大小触发落盘
-    const unsigned long FLUSH_INTERVAL_MS = 500; // 间隔达到该时间触发落盘
-    // 追加到缓冲
-    // 预留与刷新阈值一致的容量，避免频繁扩容导致的碎片与开销
-    s_buffer.reserve(FLUSH_THRESHOLD_BYTES);
-    s_buffer += line;
-    s_buffer += '\n';
-
+    // 格式化到栈上的单行缓冲，再追加到预分配的日志缓冲，不产生 String 临时对象
+    char line[LOG_LINE_MAX];
     const unsigned long now = millis();
-    const bool needFlush = (s_buffer.length() >= FLUSH_THRESHOLD_BYTES) || (now - s_lastFlush >= FLUSH_INTERVAL_MS);
-    if (!needFlush) return; // 还不到落盘条件，快速返回，避免阻塞
+    int n = snprintf(line, sizeof(line), "%lu ", now);
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(line + n, sizeof(line) - n, fmt, args);
+    va_end(args);
+    size_t len = strlen(line);
+    if (logFill + len + 1 > sizeof(logBuffer)) {
+        flushLog();
+    }
+    if (logFill + len + 1 > sizeof(logBuffer)) {
+        return; // 文件系统不可用且缓冲已满时丢弃
+    }
+    memcpy(logBuffer + logFill, line, len);
+    logFill += len;
+    logBuffer[logFill++] = '\n';
+    // 以阈值/时间间隔批量落盘，避免频繁文件写阻塞音频
+    if (logFill + LOG_LINE_MAX > sizeof(logBuffer) || now - lastLogFlush >= LOG_FLUSH_INTERVAL_MS) {
+        flushLog();
+    }
+}
+
+void Radar::flushLog() {
+    if (logFill == 0) return;
+    StallPhaseScope phaseScope(watchdog, PHASE_LOG_FLUSH);
     if (!LittleFS.begin()) return; // 文件系统不可用时延迟落盘，保留缓冲
     // 检查大小，超过上限则旋转（仅在落盘时检查，降低开销）
     if (LittleFS.exists("/radar.log")) {
@@ -423,10 +933,17 @@ void Radar::writeLog(const String &line) {
         f = LittleFS.open("/radar.log", "w");
     }
     if (f) {
-        f.print(s_buffer);
+        f.write((const uint8_t *) logBuffer, logFill);
         f.close();
-        s_buffer = "";
-        s_buffer.reserve(FLUSH_THRESHOLD_BYTES);
-        s_lastFlush = now;
+        logFill = 0;
+        lastLogFlush = millis();
     }
 }
+#else
+void Radar::writeLog(const char *fmt, ...) {
+    (void) fmt;
+}
+
+void Radar::flushLog() {
+}
+#endif // RADAR_FEATURE_LOG
@@ -2,34 +2,71 @@
 #define RADAR_PLAYER_H
 
 #include <Arduino.h>
-#include <SoftwareSerial.h>
+#include "FeatureProfile.h"
+#if RADAR_FEATURE_AUDIO
 #include <AudioFileSourceLittleFS.h>
 #include <AudioGeneratorMP3.h>
 #include <AudioOutputI2S.h>
 #include <AudioOutputI2SNoDAC.h>
+#include "AudioGeneratorTone.h"
+#include "AudioFileSourceClip.h"
+#include "AudioFileSourceAsset.h"
+#include "Mp3Scanner.h"
+#endif
+#include "RadarSensor.h"
+#include "RadarLinkHealth.h"
+#include "TrafficStats.h"
+#include "RideRecorder.h"
+#if RADAR_FEATURE_TELEMETRY
+#include "Telemetry.h"
+#endif
+#include "StallWatchdog.h"
+#include "AssetStore.h"
+#include "ClutterMap.h"
 #include "ConfigManager.h"
 
 #define LEFT_LIGHT_PIN D1
 #define RIGHT_LIGHT_PIN D2
 #define REAR_LIGHT_PIN D0
 
-struct RadarTarget {
-    bool approaching;
-    uint8_t distance;
-    uint8_t speed;
-    int8_t angle;
-    unsigned long timestamp;
+#define PROFILE_FLASH_MS 150            // 档位提示的亮/灭时长
+// 雷达数量：1 为仅正后方；2 增加左后方；3 再增加右后方。接线与安装角度见 Radar.cpp
+#ifndef RADAR_SENSOR_COUNT
+#define RADAR_SENSOR_COUNT 1
+#endif
+// 侧向雷达的安装角度（相对正后方，度）
+#ifndef RADAR_SIDE_MOUNT_DEG
+#define RADAR_SIDE_MOUNT_DEG 30
+#endif
+
+// 每轮新帧从读取串口到完成预警判断的 CPU 周期数，用于比较各编译配置的热路径开销
+struct FrameCycleStats {
+    uint32_t frames;
+    uint32_t last;
+    uint32_t max;
+    uint64_t sum;
 };
 
 class Radar {
 private:
-    SoftwareSerial *radarSerial;
+    RadarSensor sensors[RADAR_SENSOR_COUNT];
+    RadarLinkHealth linkHealth[RADAR_SENSOR_COUNT];
+    uint8_t linkFaultMask = 0;  // 链路故障的传感器位图
+    bool faultLightOn = false;
+    // 本轮各传感器新帧的目标合并后统一做一次预警判断
+    RadarTarget fusedTargets[RADAR_SENSOR_COUNT * RADAR_MAX_TARGETS];
     ConfigManager *configMgr;
+#if RADAR_FEATURE_AUDIO
     AudioGeneratorMP3 *mp3;
-    AudioFileSourceLittleFS *file;
+    void *mp3Arena;             // MP3 解码器的预分配缓冲，配置模式之外常驻
+    AudioGeneratorTone tone;
+    // 当前使用的音频发生器（mp3 或 tone）
+    AudioGenerator *player;
+    AudioFileSourceClip file;   // 每次预警复用，只重新打开文件
+    AudioFileSourceAsset assetFile; // 内置音效直接读闪存
+    AudioFileSource *source;    // 当前播放使用的音频源
     AudioOutput *out;
-    uint8_t buffer[128];
-    int bufferIndex;
+#endif
 
     unsigned long leftLightLastBlinkTime;
     unsigned long rightLightLastBlinkTime;
@@ -43,40 +80,149 @@ private:
     bool leftLightPinState = false;
     bool rightLightPinState = false;
 
+    // 档位提示：剩余亮灭步数，预警触发时取消
+    uint8_t indicatorSteps = 0;
+    unsigned long indicatorLastStep = 0;
+
+#if RADAR_FEATURE_AUDIO
     // 音频播放开始时间，用于最大时长兜底
     unsigned long audioStartTime = 0;
     // 当前音频允许的最大播放时长（毫秒），根据文件名和配置决定
     unsigned long currentMaxAudioMs = 0;
 
+    // 各音效的帧索引缓存，避免每次预警都读取旁路索引文件
+    Mp3IndexHeader audioIndex[ALERT_COUNT];
+    bool audioIndexValid[ALERT_COUNT];
+    // 各音效在内置资源镜像中的下标，-1 表示从 LittleFS 播放（上传的音效覆盖内置音效）
+    int8_t audioAsset[ALERT_COUNT];
+    // 正在播放的 mp3 音效，合成音或空闲时为 ALERT_NONE
+    AlertId currentAlert = ALERT_NONE;
+    // 正在播放档位提示音：优先级最低，任何预警音都可打断
+    bool indicatorBeep = false;
+#endif
+
+    TrafficStats stats;
+    RideRecorder rideRecorder;
+    ClutterMap clutter;
+#if RADAR_FEATURE_TELEMETRY
+    Telemetry *telemetry = nullptr;
+#endif
+    StallWatchdog *watchdog = nullptr;
+    const AssetStore *assets = nullptr;
+    // 最近一次预警是否为危险等级，用于遥测告警状态
+    bool alertDanger = false;
+
     // 全局最近一次目标
     bool hasLastTarget = false;
     RadarTarget lastTarget;
 
-    bool parseRadarData();
+    FrameCycleStats frameCycles;
+
+    void pollSensors();
+
+    __attribute__((always_inline)) void enterPhase(LoopPhase phase) {
+        if (watchdog != nullptr) {
+            watchdog->enter(phase);
+        }
+    }
 
-    void processTargets(uint8_t targetCount, uint8_t *data);
+    void processTargets(const RadarTarget *targets, uint8_t targetCount);
 
-    void triggerAudioWarning(bool left, bool right,bool isDanger);
+    void triggerAudioWarning(bool left, bool right, bool isDanger, const RadarTarget &target);
 
     void triggerLightWarning(bool left, bool right, bool isDanger);
 
     void updateLightBehavior();
 
-    void writeLog(const String &line);
+    void updateIndicator();
+
+    // 检查各路雷达链路，故障时执行恢复动作
+    void checkLinks(unsigned long now);
+
+    // 链路故障时尾灯双闪，预警灯光优先
+    void updateFaultLight();
+
+#if RADAR_FEATURE_LOG
+    // 预分配的日志缓冲
+    char logBuffer[2048];
+    size_t logFill;
+    unsigned long lastLogFlush;
+#endif
+
+    // 关闭日志功能时为空函数，调用处以 FEATURE_LOG && cfg.logEnabled 判断
+    void writeLog(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    void flushLog();
+
+#if RADAR_FEATURE_AUDIO
+    void serviceAudio();
 
     void stopAudioAndResetLights();
 
-    unsigned long getMaxAudioMsForPath(const String &path);
+    unsigned long getMaxAudioMs(AlertId alert) const;
+
+    void stopPlayer();
+#endif
+
+    // 以下音频函数在关闭音频功能时为空实现，调用处以 FEATURE_AUDIO && cfg.audioEnabled 判断
+    bool playTone(uint16_t freqHz, uint16_t periodMs, uint16_t onMs, bool chirpOn, unsigned long maxMs);
+
+    bool playSynthPreset(bool directional, bool isDanger);
+
+    void updateToneThreat(const RadarTarget &target, bool isDanger);
 public:
     Radar(ConfigManager *configMgr);
 
     void begin();
 
+#if RADAR_FEATURE_TELEMETRY
+    void setTelemetry(Telemetry *t);
+#endif
+
+    void setWatchdog(StallWatchdog *w);
+
+    void setAssetStore(const AssetStore *a);
+
     void warning();
 
-    void testFunction(String function);
+    void testFunction(AlertId alert);
+
+    // 切换档位后的确认：第 index+1 档响 index+1 声并闪灯 index+1 次
+    void indicateProfile(uint8_t index);
+
+    bool playAlert(AlertId alert);
+
+    bool isAudioBusy() const;
+
+    // 重新确定各音效的来源并读取帧索引，上传音效后调用
+    void reloadAudioIndex();
+
+    // 预留 MP3 解码缓冲并以其重建解码器，放不下时保持播放时分配；返回是否已预留
+    bool reserveAudioArena();
+
+    // 开启配置模式前调用：停止 mp3 播放并把解码缓冲还给热点与网页服务
+    void releaseAudioArena();
+
+    const TrafficStats &getStats() const;
+
+    void resetStats();
+
+    const ClutterMap &getClutterMap() const;
+
+    void resetClutterMap();
+
+    uint8_t getSensorCount() const;
+
+    const RadarSensor &getSensor(uint8_t index) const;
+
+    const RadarLinkHealth &getLinkHealth(uint8_t index) const;
+
+    void writeSensorJson(Print &out) const;
+
+    const FrameCycleStats &getFrameCycles() const;
 
-    bool playAudio(String audio);
+    // 编译配置、已启用功能与每帧周期统计
+    void writeProfileJson(Print &out) const;
 };
 
 #endif // RADAR_PLAYER_H
@@ -0,0 +1,174 @@
+#include "RadarLinkHealth.h"
+
+static const char *const LINK_STATE_NAMES[] = {"ok", "degraded", "silent"};
+
+RadarLinkHealth::RadarLinkHealth() {
+    begin(0);
+}
+
+void RadarLinkHealth::begin(unsigned long now) {
+    state = LINK_OK;
+    seenFrames = 0;
+    lastFrameMs = now;
+    gapMeanX8 = 0;
+    gapDevX4 = 0;
+    lastGapMs = 0;
+    windowMaxGapMs = 0;
+    maxGapMs = 0;
+    windowStart = now;
+    baseFrames = 0;
+    baseBad = 0;
+    baseResyncs = 0;
+    winFrames = 0;
+    winBad = 0;
+    winResyncs = 0;
+    faultSince = 0;
+    lastActionMs = 0;
+    attempts = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void RadarLinkHealth::noteGap(uint32_t gapMs) {
+    lastGapMs = gapMs;
+    if (gapMs > windowMaxGapMs) {
+        windowMaxGapMs = gapMs;
+    }
+    if (gapMeanX8 == 0) {
+        gapMeanX8 = gapMs << 3;
+        gapDevX4 = gapMs << 1;
+        return;
+    }
+    // mean += err/8，dev += (|err| - dev)/4，均为定点整数运算
+    const int32_t err = (int32_t) gapMs - (int32_t) (gapMeanX8 >> 3);
+    gapMeanX8 = (uint32_t) ((int32_t) gapMeanX8 + err);
+    gapDevX4 = gapDevX4 + (uint32_t) abs(err) - (gapDevX4 >> 2);
+}
+
+void RadarLinkHealth::closeWindow(const RadarSensorCounters &c, unsigned long now) {
+    winFrames = c.frames - baseFrames;
+    winBad = c.badFrames - baseBad;
+    winResyncs = c.resyncs - baseResyncs;
+    baseFrames = c.frames;
+    baseBad = c.badFrames;
+    baseResyncs = c.resyncs;
+    const uint32_t elapsed = now - windowStart;
+    windowStart = now;
+    maxGapMs = windowMaxGapMs;
+    windowMaxGapMs = 0;
+    const uint32_t events = winFrames + winBad;
+    const bool noisy = events >= LINK_MIN_EVENTS && (winBad + winResyncs) * 100 >= events * LINK_BAD_PERCENT;
+    if (noisy && state == LINK_OK) {
+        enterFault(LINK_DEGRADED, now, elapsed);
+    } else if (!noisy && state == LINK_DEGRADED && winFrames > 0) {
+        recover(now);
+    }
+}
+
+void RadarLinkHealth::enterFault(LinkState s, unsigned long now, uint32_t detectMs) {
+    // 劣化后又静默仍算同一次故障
+    if (state == LINK_OK) {
+        stats.faults++;
+        stats.lastDetectMs = detectMs;
+        faultSince = now;
+        attempts = 0;
+    }
+    state = s;
+}
+
+void RadarLinkHealth::recover(unsigned long now) {
+    stats.lastRecoverMs = now - faultSince;
+    if (stats.lastRecoverMs > stats.maxRecoverMs) {
+        stats.maxRecoverMs = stats.lastRecoverMs;
+    }
+    state = LINK_OK;
+    attempts = 0;
+}
+
+LinkAction RadarLinkHealth::update(const RadarSensorCounters &c, unsigned long now, uint16_t windowMs,
+                                   bool canRestart) {
+    if (windowMs < LINK_WINDOW_MIN_MS) {
+        windowMs = LINK_WINDOW_MIN_MS;
+    }
+    if (c.frames != seenFrames) {
+        // 同一轮收到多帧时按最新一帧计一次间隔；首帧之前的等待不计入
+        if (seenFrames > 0) {
+            noteGap(c.lastFrameMs - lastFrameMs);
+        }
+        seenFrames = c.frames;
+        lastFrameMs = c.lastFrameMs;
+        if (state == LINK_SILENT) {
+            recover(now);
+        }
+    }
+    if (now - windowStart >= windowMs) {
+        closeWindow(c, now);
+    }
+    if (state != LINK_SILENT && now - lastFrameMs >= windowMs) {
+        enterFault(LINK_SILENT, now, now - lastFrameMs);
+    }
+    if (state == LINK_OK) {
+        return LINK_ACTION_NONE;
+    }
+    // 判定故障后立即动作一次，之后间隔按 1、2、4…个窗口退避
+    if (attempts > 0) {
+        const uint8_t shift = attempts - 1 < LINK_BACKOFF_MAX_SHIFT ? attempts - 1 : LINK_BACKOFF_MAX_SHIFT;
+        if (now - lastActionMs < ((uint32_t) windowMs << shift)) {
+            return LINK_ACTION_NONE;
+        }
+    }
+    lastActionMs = now;
+    attempts++;
+    // 先重开串口；仍未恢复时改为重启模块，之后交替进行
+    if (canRestart && attempts % 2 == 0) {
+        stats.restarts++;
+        return LINK_ACTION_RESTART;
+    }
+    stats.reopens++;
+    return LINK_ACTION_REOPEN;
+}
+
+LinkState RadarLinkHealth::getState() const {
+    return state;
+}
+
+bool RadarLinkHealth::isFaulted() const {
+    return state != LINK_OK;
+}
+
+const RadarLinkStats &RadarLinkHealth::getStats() const {
+    return stats;
+}
+
+void RadarLinkHealth::writeJson(Print &out, unsigned long now) const {
+    out.print("{\"state\":\"");
+    out.print(LINK_STATE_NAMES[state]);
+    out.print("\",\"gapMeanMs\":");
+    out.print(gapMeanX8 >> 3);
+    out.print(",\"gapJitterMs\":");
+    out.print(gapDevX4 >> 2);
+    out.print(",\"lastGapMs\":");
+    out.print(lastGapMs);
+    out.print(",\"maxGapMs\":");
+    out.print(maxGapMs);
+    out.print(",\"windowFrames\":");
+    out.print(winFrames);
+    out.print(",\"windowBad\":");
+    out.print(winBad);
+    out.print(",\"windowResyncs\":");
+    out.print(winResyncs);
+    out.print(",\"faults\":");
+    out.print(stats.faults);
+    out.print(",\"reopens\":");
+    out.print(stats.reopens);
+    out.print(",\"restarts\":");
+    out.print(stats.restarts);
+    out.print(",\"lastDetectMs\":");
+    out.print(stats.lastDetectMs);
+    out.print(",\"lastRecoverMs\":");
+    out.print(stats.lastRecoverMs);
+    out.print(",\"maxRecoverMs\":");
+    out.print(stats.maxRecoverMs);
+    out.print(",\"faultForMs\":");
+    out.print(state != LINK_OK ? (long) (now - faultSince) : 0L);
+    out.print('}');
+}
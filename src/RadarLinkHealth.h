@@ -0,0 +1,88 @@
+#ifndef RADAR_LINK_HEALTH_H
+#define RADAR_LINK_HEALTH_H
+
+#include <Arduino.h>
+#include "RadarSensor.h"
+
+#define LINK_WINDOW_MIN_MS 200
+#define LINK_MIN_EVENTS 4               // 窗口内帧数过少时不判断劣化
+#define LINK_BAD_PERCENT 25             // 窗口内坏帧与重同步次数达到帧数的此比例判为劣化
+#define LINK_BACKOFF_MAX_SHIFT 4        // 恢复动作的重试间隔最多放大到 16 个窗口
+#define LINK_FAULT_PERIOD_MS 2000       // 故障尾灯：每周期双闪一次
+
+enum LinkState : uint8_t {
+    LINK_OK,
+    LINK_DEGRADED,                      // 仍有帧，但坏帧或重同步过多
+    LINK_SILENT                         // 一个窗口内没有收到完整帧
+};
+
+enum LinkAction : uint8_t {
+    LINK_ACTION_NONE,
+    LINK_ACTION_REOPEN,                 // 重新打开软串口并复位解析器
+    LINK_ACTION_RESTART                 // 向模块发送重启命令（需接 TX）
+};
+
+struct RadarLinkStats {
+    uint32_t faults;
+    uint32_t reopens;
+    uint32_t restarts;
+    uint32_t lastDetectMs;              // 最近一次故障：从最后一个正常帧（或劣化窗口起点）到判定故障
+    uint32_t lastRecoverMs;             // 最近一次故障：从判定故障到恢复
+    uint32_t maxRecoverMs;
+};
+
+// 单路雷达的链路健康监测：每轮以传感器计数器更新，开销 O(1)。
+// 帧间隔用指数滑动平均与平均偏差跟踪（均值系数 1/8、偏差系数 1/4），
+// 坏帧与重同步按窗口计数；一个窗口无帧判为静默，窗口内错误占比过高判为劣化，
+// 故障期间按退避间隔交替返回重开串口与重启模块的动作，直到恢复
+class RadarLinkHealth {
+private:
+    LinkState state;
+    uint32_t seenFrames;
+    unsigned long lastFrameMs;
+
+    uint32_t gapMeanX8;                 // 帧间隔均值 ×8（ms）
+    uint32_t gapDevX4;                  // 帧间隔平均偏差 ×4（ms）
+    uint32_t lastGapMs;
+    uint32_t windowMaxGapMs;
+    uint32_t maxGapMs;                  // 上一个完整窗口内的最大帧间隔
+
+    unsigned long windowStart;
+    uint32_t baseFrames;                // 窗口起点时的计数
+    uint32_t baseBad;
+    uint32_t baseResyncs;
+    uint32_t winFrames;                 // 上一个完整窗口的计数
+    uint32_t winBad;
+    uint32_t winResyncs;
+
+    unsigned long faultSince;
+    unsigned long lastActionMs;
+    uint8_t attempts;
+    RadarLinkStats stats;
+
+    void noteGap(uint32_t gapMs);
+
+    void closeWindow(const RadarSensorCounters &c, unsigned long now);
+
+    void enterFault(LinkState s, unsigned long now, uint32_t detectMs);
+
+    void recover(unsigned long now);
+
+public:
+    RadarLinkHealth();
+
+    void begin(unsigned long now);
+
+    // 每轮调用，返回需要执行的恢复动作；canRestart 为 false 时只重开串口
+    LinkAction update(const RadarSensorCounters &c, unsigned long now, uint16_t windowMs, bool canRestart);
+
+    LinkState getState() const;
+
+    bool isFaulted() const;
+
+    const RadarLinkStats &getStats() const;
+
+    void writeJson(Print &out, unsigned long now) const;
+};
+
+#endif // RADAR_LINK_HEALTH_H
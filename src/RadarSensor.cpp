@@ -0,0 +1,199 @@
+#include "RadarSensor.h"
+
+static const uint8_t FRAME_HEADER[4] = {0xF4, 0xF3, 0xF2, 0xF1};
+static const uint8_t FRAME_FOOTER[4] = {0xF8, 0xF7, 0xF6, 0xF5};
+static const uint8_t TARGET_SIZE = 5;
+// 命令帧：FD FC FB FA + 长度(2) + 命令字(2) + 参数 + 04 03 02 01
+static const uint8_t CMD_ENABLE_CONFIG[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x04, 0x00, 0xFF, 0x00, 0x01, 0x00,
+                                            0x04, 0x03, 0x02, 0x01};
+static const uint8_t CMD_RESTART[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, 0xA3, 0x00, 0x04, 0x03, 0x02, 0x01};
+
+RadarSensor::RadarSensor() {
+    id = 0;
+    rxPin = -1;
+    txPin = -1;
+    mountAngle = 0;
+    useSerial = false;
+    input = nullptr;
+    memset(&counters, 0, sizeof(counters));
+    hunting = false;
+    resetParser();
+}
+
+void RadarSensor::attach(uint8_t id, int8_t rxPin, int8_t txPin, int8_t mountAngle) {
+    this->id = id;
+    this->rxPin = rxPin;
+    this->txPin = txPin;
+    this->mountAngle = mountAngle;
+    useSerial = true;
+    input = &serial;
+}
+
+void RadarSensor::attach(uint8_t id, Stream *input, int8_t mountAngle) {
+    this->id = id;
+    this->mountAngle = mountAngle;
+    useSerial = false;
+    this->input = input;
+}
+
+void RadarSensor::begin() {
+    if (useSerial) {
+        serial.begin(RADAR_BAUD, SWSERIAL_8N1, rxPin, txPin, false, RADAR_RX_BUFFER_SIZE);
+    }
+}
+
+void RadarSensor::reopen() {
+    if (useSerial) {
+        serial.end();
+        serial.begin(RADAR_BAUD, SWSERIAL_8N1, rxPin, txPin, false, RADAR_RX_BUFFER_SIZE);
+    }
+    resetParser();
+    hunting = false;
+}
+
+bool RadarSensor::canRestart() const {
+    return useSerial && txPin >= 0;
+}
+
+bool RadarSensor::restartModule() {
+    if (!canRestart()) {
+        return false;
+    }
+    serial.write(CMD_ENABLE_CONFIG, sizeof(CMD_ENABLE_CONFIG));
+    serial.write(CMD_RESTART, sizeof(CMD_RESTART));
+    // 命令应答不是数据帧，由帧头查找丢弃
+    resetParser();
+    return true;
+}
+
+void RadarSensor::resetParser() {
+    state = PARSE_HEADER;
+    matched = 0;
+    length = 0;
+    fill = 0;
+}
+
+bool RadarSensor::feed(uint8_t b) {
+    switch (state) {
+        case PARSE_HEADER:
+            if (b == FRAME_HEADER[matched]) {
+                if (++matched == sizeof(FRAME_HEADER)) {
+                    state = PARSE_LENGTH;
+                    matched = 0;
+                    length = 0;
+                    if (hunting) {
+                        counters.resyncs++;
+                        hunting = false;
+                    }
+                }
+            } else {
+                // 帧头各字节互不相同，失配时只需判断当前字节能否作为新的起点
+                matched = b == FRAME_HEADER[0] ? 1 : 0;
+                hunting = true;
+            }
+            break;
+        case PARSE_LENGTH:
+            length |= (uint16_t) b << (8 * matched);
+            if (++matched == 2) {
+                matched = 0;
+                fill = 0;
+                if (length > RADAR_FRAME_MAX_PAYLOAD) {
+                    counters.badFrames++;
+                    resetParser();
+                } else {
+                    state = length > 0 ? PARSE_PAYLOAD : PARSE_FOOTER;
+                }
+            }
+            break;
+        case PARSE_PAYLOAD:
+            payload[fill++] = b;
+            if (fill == length) {
+                state = PARSE_FOOTER;
+            }
+            break;
+        case PARSE_FOOTER:
+            if (b != FRAME_FOOTER[matched]) {
+                counters.badFrames++;
+                resetParser();
+                matched = b == FRAME_HEADER[0] ? 1 : 0;
+                // 之后找到的帧头计为一次重同步，链路健康据此计算错误占比
+                hunting = true;
+                break;
+            }
+            if (++matched == sizeof(FRAME_FOOTER)) {
+                state = PARSE_HEADER;
+                matched = 0;
+                return true;
+            }
+            break;
+    }
+    return false;
+}
+
+uint8_t RadarSensor::decodeFrame(RadarTarget *targets, unsigned long now) {
+    // 负载：目标数量(1) + 报警信息(1) + 每个目标 5 字节
+    if (length < 2) {
+        return 0;
+    }
+    const uint8_t targetCount = payload[0];
+    if (2 + (uint16_t) targetCount * TARGET_SIZE > length) {
+        counters.badFrames++;
+        return 0;
+    }
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < targetCount && count < RADAR_MAX_TARGETS; i++) {
+        const uint8_t *data = &payload[2 + i * TARGET_SIZE];
+        const int8_t localAngle = (int8_t) (data[0] - 0x80);
+        // 超出本地视场的角度不可信，在转换到车身坐标前丢弃
+        if (localAngle <= -RADAR_SENSOR_FOV_DEG || localAngle >= RADAR_SENSOR_FOV_DEG) {
+            continue;
+        }
+        RadarTarget &t = targets[count++];
+        t.approaching = data[2] == 0x01;
+        t.distance = data[1];
+        t.speed = data[3];
+        t.angle = (int8_t) constrain(localAngle + mountAngle, -127, 127);
+        t.timestamp = now;
+        t.sensor = id;
+    }
+    return count;
+}
+
+bool RadarSensor::poll(RadarTarget *targets, uint8_t &count, unsigned long now) {
+    bool gotFrame = false;
+    count = 0;
+    if (input == nullptr) {
+        return false;
+    }
+    if (useSerial && serial.overflow()) {
+        counters.overflows++;
+    }
+    while (input->available()) {
+        const int c = input->read();
+        if (c < 0) {
+            break;
+        }
+        counters.bytes++;
+        if (feed((uint8_t) c)) {
+            // 同一轮收到多帧时只保留最新一帧，旧帧已经过时
+            counters.frames++;
+            counters.lastFrameMs = now;
+            count = decodeFrame(targets, now);
+            gotFrame = true;
+            yield();
+        }
+    }
+    return gotFrame;
+}
+
+uint8_t RadarSensor::getId() const {
+    return id;
+}
+
+int8_t RadarSensor::getMountAngle() const {
+    return mountAngle;
+}
+
+const RadarSensorCounters &RadarSensor::getCounters() const {
+    return counters;
+}
@@ -0,0 +1,93 @@
+#ifndef RADAR_SENSOR_H
+#define RADAR_SENSOR_H
+
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+
+#define RADAR_BAUD 115200
+#define RADAR_RX_BUFFER_SIZE 256        // 每路软串口的接收环形缓冲，覆盖音频解码期间约 20ms 的数据
+#define RADAR_FRAME_MAX_PAYLOAD 118     // 与原 128 字节解析缓冲一致（不含帧头、长度、帧尾）
+#define RADAR_MAX_TARGETS 8             // 单帧最多解码的目标数
+#define RADAR_SENSOR_FOV_DEG 12         // 雷达本地角度可信范围（开区间 ±12°）
+
+struct RadarTarget {
+    bool approaching;
+    uint8_t distance;
+    uint8_t speed;
+    int8_t angle;               // 车身坐标系角度：本地角度 + 安装角度，负值为左
+    unsigned long timestamp;
+    uint8_t sensor;             // 来源传感器编号
+};
+
+struct RadarSensorCounters {
+    uint32_t bytes;
+    uint32_t frames;
+    uint32_t badFrames;         // 长度越界、帧尾不符或目标数与长度不一致
+    uint32_t overflows;         // 软串口接收缓冲溢出次数
+    uint32_t resyncs;           // 丢弃非帧头字节后才找到下一帧的次数
+    unsigned long lastFrameMs;
+};
+
+// 单个 LD2451 的输入、帧解析与目标解码。逐字节状态机解析，每字节 O(1)，
+// 不再像整块缓冲那样每收一个字节都从头查找帧头
+class RadarSensor {
+private:
+    enum ParseState : uint8_t {
+        PARSE_HEADER,
+        PARSE_LENGTH,
+        PARSE_PAYLOAD,
+        PARSE_FOOTER
+    };
+
+    uint8_t id;
+    int8_t rxPin;
+    int8_t txPin;
+    int8_t mountAngle;
+    SoftwareSerial serial;      // 随对象静态分配，begin 时再指定引脚
+    bool useSerial;
+    Stream *input;
+
+    ParseState state;
+    uint8_t matched;            // 帧头/帧尾已匹配字节数，或长度字段已读字节数
+    uint16_t length;
+    uint16_t fill;
+    bool hunting;               // 查找帧头时已丢弃过字节
+    uint8_t payload[RADAR_FRAME_MAX_PAYLOAD];
+
+    RadarSensorCounters counters;
+
+    void resetParser();
+
+    bool feed(uint8_t b);
+
+    uint8_t decodeFrame(RadarTarget *targets, unsigned long now);
+
+public:
+    RadarSensor();
+
+    void attach(uint8_t id, int8_t rxPin, int8_t txPin, int8_t mountAngle);
+
+    // 从任意 Stream 读取（串口回放等），不使用软串口
+    void attach(uint8_t id, Stream *input, int8_t mountAngle);
+
+    void begin();
+
+    // 重新打开软串口并复位解析器，链路静默或劣化时调用
+    void reopen();
+
+    bool canRestart() const;
+
+    // 按海凌科串口协议发送使能配置与重启命令，模块约 1 秒后重新上报；未接 TX 时返回 false
+    bool restartModule();
+
+    // 读取当前可用的全部字节；有完整帧时返回 true，并把最新一帧的目标写入 targets（最多 RADAR_MAX_TARGETS 个）
+    bool poll(RadarTarget *targets, uint8_t &count, unsigned long now);
+
+    uint8_t getId() const;
+
+    int8_t getMountAngle() const;
+
+    const RadarSensorCounters &getCounters() const;
+};
+
+#endif // RADAR_SENSOR_H
@@ -0,0 +1,144 @@
+#include "RideProfiles.h"
+#include <LittleFS.h>
+
+RideProfiles::RideProfiles() {
+    memset(&record, 0, sizeof(record));
+    memset(states, 0, sizeof(states));
+    active = 0;
+}
+
+void RideProfiles::derive(const RideProfile &profile, RideProfileState &state) {
+    state.detectionDistance = profile.detectionDistance;
+    state.detectionSpeed = profile.detectionSpeed;
+    state.dangerDistance = profile.dangerDistance;
+    state.dangerSpeed = profile.dangerSpeed;
+    state.lightBlink = (profile.flags & PROFILE_LIGHT_BLINK) != 0;
+    state.blinkDurationMs = (unsigned long) profile.blinkDuration * 1000UL;
+    state.blinkIntervalMs[0] = profile.normalBlinkInterval;
+    state.blinkIntervalMs[1] = profile.dangerBlinkInterval;
+    // 方向表：不区分方向时左右同亮；否则 ±centerAngle° 以内视为正后方
+    const int16_t center = profile.centerAngle;
+    memset(state.direction, 0, sizeof(state.direction));
+    for (int16_t angle = -128; angle <= 127; angle++) {
+        uint8_t dir = PROFILE_DIR_LEFT | PROFILE_DIR_RIGHT;
+        if (profile.flags & PROFILE_LIGHT_ANGLE) {
+            if (angle <= -center) {
+                dir = PROFILE_DIR_LEFT;
+            } else if (angle >= center) {
+                dir = PROFILE_DIR_RIGHT;
+            }
+        }
+        const uint8_t i = (uint8_t) (angle + 128);
+        state.direction[i >> 2] |= dir << ((i & 3) * 2);
+    }
+}
+
+bool RideProfiles::load() {
+    File file = LittleFS.open(RIDE_PROFILE_PATH, "r");
+    if (!file) {
+        return false;
+    }
+    RideProfileFile loaded;
+    const bool ok = file.read((uint8_t *) &loaded, sizeof(loaded)) == sizeof(loaded);
+    file.close();
+    if (!ok || loaded.magic != RIDE_PROFILE_MAGIC || loaded.count == 0 || loaded.count > RIDE_PROFILE_MAX
+        || loaded.bootProfile >= loaded.count) {
+        return false;
+    }
+    record = loaded;
+    for (uint8_t i = 0; i < record.count; i++) {
+        record.profiles[i].name[RIDE_PROFILE_NAME_LEN - 1] = '\0';
+        derive(record.profiles[i], states[i]);
+    }
+    active = record.bootProfile;
+    return true;
+}
+
+void RideProfiles::seed(const RideProfile &base) {
+    memset(&record, 0, sizeof(record));
+    record.magic = RIDE_PROFILE_MAGIC;
+    record.count = 3;
+    record.bootProfile = 0;
+
+    RideProfile &def = record.profiles[0];
+    def = base;
+    strlcpy(def.name, "默认", sizeof(def.name));
+
+    // 城市：车速低、车距近，缩短检测距离以减少误报
+    RideProfile &city = record.profiles[1];
+    city = base;
+    strlcpy(city.name, "城市", sizeof(city.name));
+    city.detectionDistance = 25;
+    city.detectionSpeed = 5;
+    city.dangerDistance = 8;
+    city.dangerSpeed = 20;
+
+    // 高速：后车接近快，拉远检测距离并提高危险速度
+    RideProfile &highway = record.profiles[2];
+    highway = base;
+    strlcpy(highway.name, "高速", sizeof(highway.name));
+    highway.detectionDistance = 70;
+    highway.detectionSpeed = 15;
+    highway.dangerDistance = 30;
+    highway.dangerSpeed = 40;
+    highway.dangerBlinkInterval = 80;
+
+    for (uint8_t i = 0; i < record.count; i++) {
+        derive(record.profiles[i], states[i]);
+    }
+    active = 0;
+}
+
+bool RideProfiles::save() const {
+    File file = LittleFS.open(RIDE_PROFILE_PATH, "w");
+    if (!file) {
+        return false;
+    }
+    const bool ok = file.write((const uint8_t *) &record, sizeof(record)) == sizeof(record);
+    file.close();
+    return ok;
+}
+
+bool RideProfiles::select(uint8_t index) {
+    if (index >= record.count) {
+        return false;
+    }
+    active = index;
+    return true;
+}
+
+uint8_t RideProfiles::next() {
+    active = active + 1 < record.count ? active + 1 : 0;
+    return active;
+}
+
+void RideProfiles::setBootProfile(uint8_t index) {
+    if (index < record.count) {
+        record.bootProfile = index;
+    }
+}
+
+void RideProfiles::update(uint8_t index, const RideProfile &profile) {
+    if (index >= record.count) {
+        return;
+    }
+    record.profiles[index] = profile;
+    record.profiles[index].name[RIDE_PROFILE_NAME_LEN - 1] = '\0';
+    derive(record.profiles[index], states[index]);
+}
+
+uint8_t RideProfiles::getCount() const {
+    return record.count;
+}
+
+uint8_t RideProfiles::getActive() const {
+    return active;
+}
+
+uint8_t RideProfiles::getBootProfile() const {
+    return record.bootProfile;
+}
+
+const RideProfile &RideProfiles::get(uint8_t index) const {
+    return record.profiles[index];
+}
@@ -0,0 +1,108 @@
+#ifndef RIDE_PROFILES_H
+#define RIDE_PROFILES_H
+
+#include <Arduino.h>
+
+#define RIDE_PROFILE_PATH "/profiles.bin"
+#define RIDE_PROFILE_MAGIC 0x31465052UL     // "RPF1"
+#define RIDE_PROFILE_MAX 4
+#define RIDE_PROFILE_NAME_LEN 12            // 含结尾 0，UTF-8 中文最多 3 个字
+
+// RideProfile::flags
+#define PROFILE_LIGHT_BLINK 0x01
+#define PROFILE_LIGHT_ANGLE 0x02
+
+// RideProfileState::direction 中每个角度的 2 位
+#define PROFILE_DIR_LEFT 0x01
+#define PROFILE_DIR_RIGHT 0x02
+
+// 可随档位切换的预警参数，按落盘格式紧凑排列
+struct RideProfile {
+    char name[RIDE_PROFILE_NAME_LEN];
+    uint8_t detectionDistance;      // m
+    uint8_t detectionSpeed;         // km/h
+    uint8_t dangerDistance;
+    uint8_t dangerSpeed;
+    uint16_t normalBlinkInterval;   // ms
+    uint16_t dangerBlinkInterval;
+    uint8_t blinkDuration;          // 秒
+    uint8_t centerAngle;            // ±centerAngle° 视为正后方
+    uint8_t flags;
+    uint8_t gainTenths;             // 音量 × 10
+};
+
+static_assert(sizeof(RideProfile) == 24, "档位记录须保持 24 字节");
+
+// /profiles.bin 的完整内容，一次读写
+struct RideProfileFile {
+    uint32_t magic;
+    uint8_t count;
+    uint8_t bootProfile;            // 开机时使用的档位
+    uint16_t reserved;
+    RideProfile profiles[RIDE_PROFILE_MAX];
+};
+
+// 由档位预先算好的预警判断参数，热路径直接查用
+struct RideProfileState {
+    uint8_t detectionDistance;
+    uint8_t detectionSpeed;
+    uint8_t dangerDistance;
+    uint8_t dangerSpeed;
+    bool lightBlink;
+    unsigned long blinkDurationMs;
+    unsigned long blinkIntervalMs[2];   // 下标为是否危险
+    uint8_t direction[64];              // 车身角度 -128°~127° 对应的亮灯方向，每个角度 2 位
+};
+
+// 骑行档位集合：全部档位存放在一个二进制文件中，启动时读入并为每个档位预先计算判断参数，
+// 之后切换档位只改当前下标，不解析 JSON、不写 flash
+class RideProfiles {
+private:
+    RideProfileFile record;
+    RideProfileState states[RIDE_PROFILE_MAX];
+    uint8_t active;
+
+    static void derive(const RideProfile &profile, RideProfileState &state);
+
+public:
+    RideProfiles();
+
+    // 读取档位文件，缺失或格式不符时返回 false
+    bool load();
+
+    // 以 base 为第一个档位，另生成城市、高速两个内置档位，只修改内存，由调用方保存
+    void seed(const RideProfile &base);
+
+    bool save() const;
+
+    // 切换当前档位，O(1)
+    bool select(uint8_t index);
+
+    // 切换到下一档位并返回其下标，O(1)
+    uint8_t next();
+
+    void setBootProfile(uint8_t index);
+
+    // 修改某一档位并重新计算其判断参数
+    void update(uint8_t index, const RideProfile &profile);
+
+    uint8_t getCount() const;
+
+    uint8_t getActive() const;
+
+    uint8_t getBootProfile() const;
+
+    const RideProfile &get(uint8_t index) const;
+
+    const RideProfileState &current() const {
+        return states[active];
+    }
+
+    // 查表得到某角度目标的亮灯方向（PROFILE_DIR_LEFT / PROFILE_DIR_RIGHT 组合）
+    static uint8_t direction(const RideProfileState &state, int8_t angle) {
+        const uint8_t i = (uint8_t) (angle + 128);
+        return (state.direction[i >> 2] >> ((i & 3) * 2)) & 0x03;
+    }
+};
+
+#endif // RIDE_PROFILES_H
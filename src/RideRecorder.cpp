@@ -0,0 +1,436 @@
+#include "RideRecorder.h"
+
+static const char *RIDE_INDEX_TMP_PATH = "/rides/index.tmp";
+static const unsigned long RIDE_FLUSH_INTERVAL_MS = 10000; // 空闲时缓冲落盘间隔
+static const unsigned long RIDE_TRACK_GAP_MS = 2000;      // 超过该间隔没有目标视为新轨迹
+static const uint8_t RIDE_TRACK_JUMP_M = 10;              // 距离突然变远超过该值视为新目标
+
+static inline uint32_t zigzagEncode(int32_t v) {
+    return ((uint32_t) v << 1) ^ (uint32_t) (v >> 31);
+}
+
+static inline int32_t zigzagDecode(uint32_t v) {
+    return (int32_t) (v >> 1) ^ -(int32_t) (v & 1);
+}
+
+RideRecorder::RideRecorder() {
+    rideId = 0;
+    segmentNo = 0;
+    ready = false;
+    started = false;
+    segmentBytes = 0;
+    archiveBytes = 0;
+    segmentStartMs = 0;
+    segmentIndexed = false;
+    fill = 0;
+    lastFlushTime = 0;
+    rollPending = false;
+    rollAt = 0;
+    rollStartMs = 0;
+    hasPrev = false;
+    keyNext = true;
+    prevTime = 0;
+    prevDistance = 0;
+    prevSpeed = 0;
+    prevAngle = 0;
+    trackId = 0;
+}
+
+void RideRecorder::segmentPath(char *out, size_t size, uint16_t ride, uint16_t segment) {
+    snprintf(out, size, RIDE_DIR "/%u_%u.bin", (unsigned) ride, (unsigned) segment);
+}
+
+void RideRecorder::begin() {
+    LittleFS.mkdir(RIDE_DIR);
+    // 索引最后一条的骑行编号 + 1 即本次骑行编号
+    File idx = LittleFS.open(RIDE_INDEX_PATH, "r");
+    if (idx) {
+        const size_t count = idx.size() / sizeof(RideSegmentInfo);
+        RideSegmentInfo e;
+        if (count > 0 && idx.seek((count - 1) * sizeof(RideSegmentInfo), SeekSet)
+            && idx.read((uint8_t *) &e, sizeof(e)) == sizeof(e)) {
+            rideId = e.ride + 1;
+        }
+        idx.close();
+    }
+    archiveBytes = 0;
+    Dir dir = LittleFS.openDir(RIDE_DIR);
+    while (dir.next()) {
+        archiveBytes += dir.fileSize();
+    }
+    lastFlushTime = millis();
+    ready = true;
+}
+
+void RideRecorder::putVarint(uint32_t v) {
+    while (v >= 0x80) {
+        buffer[fill++] = (uint8_t) (v | 0x80);
+        v >>= 7;
+    }
+    buffer[fill++] = (uint8_t) v;
+}
+
+// 新段从下一条记录开始，以绝对值记录开头；只改内存状态
+void RideRecorder::startSegment(uint32_t nowMs) {
+    segmentBytes = 0;
+    keyNext = true;
+    prevTime = nowMs;
+}
+
+// 追加到当前段文件；数据写入成功后才补写索引，索引中的段总有数据可读
+bool RideRecorder::writeSegment(const uint8_t *data, uint16_t len) {
+    if (len == 0) {
+        return true;
+    }
+    char path[32];
+    segmentPath(path, sizeof(path), rideId, segmentNo);
+    File f = LittleFS.open(path, "a");
+    if (!f) {
+        return false;
+    }
+    const bool ok = f.write(data, len) == len;
+    f.close();
+    archiveBytes += len;
+    if (!ok || segmentIndexed) {
+        return ok;
+    }
+    const RideSegmentInfo e = {rideId, segmentNo, segmentStartMs};
+    File idx = LittleFS.open(RIDE_INDEX_PATH, "a");
+    if (!idx) {
+        return false;
+    }
+    segmentIndexed = idx.write((const uint8_t *) &e, sizeof(e)) == sizeof(e);
+    idx.close();
+    archiveBytes += sizeof(e);
+    return segmentIndexed;
+}
+
+void RideRecorder::recordFrame(uint8_t distance, uint8_t speed, int8_t angle) {
+    if (!ready) {
+        return;
+    }
+    // 缓冲已满而 loop 尚未落盘（如音频播放中）时丢弃；下一条记录的时间差照常从上一条算起
+    if (fill + RIDE_RECORD_MAX > RIDE_BUFFER_SIZE) {
+        return;
+    }
+    const uint32_t now = millis();
+    if (!started) {
+        started = true;
+        segmentStartMs = now;
+        startSegment(now);
+    } else if (segmentBytes + RIDE_RECORD_MAX > RIDE_SEGMENT_SIZE) {
+        // 当前段已满：记下切换点，由 loop 落盘时分别写入旧段与新段
+        if (rollPending) {
+            return;
+        }
+        rollPending = true;
+        rollAt = fill;
+        rollStartMs = now;
+        startSegment(now);
+    }
+    const bool newTrack = !hasPrev || now - prevTime > RIDE_TRACK_GAP_MS || distance > prevDistance + RIDE_TRACK_JUMP_M;
+    const bool key = newTrack || keyNext;
+    if (newTrack) {
+        trackId++;
+    }
+    const uint32_t dt10 = (now - prevTime) / 10;
+    const uint16_t before = fill;
+    putVarint((dt10 << 2) | (newTrack ? 2 : 0) | (key ? 1 : 0));
+    if (key) {
+        putVarint(trackId);
+        putVarint(distance);
+        putVarint(speed);
+        putVarint(zigzagEncode(angle));
+    } else {
+        putVarint(zigzagEncode((int32_t) distance - prevDistance));
+        putVarint(zigzagEncode((int32_t) speed - prevSpeed));
+        putVarint(zigzagEncode((int32_t) angle - prevAngle));
+    }
+    segmentBytes += fill - before;
+    // 按 10ms 步进累计时间，避免舍入误差逐帧累积
+    prevTime += dt10 * 10;
+    prevDistance = distance;
+    prevSpeed = speed;
+    prevAngle = angle;
+    hasPrev = true;
+    keyNext = false;
+}
+
+bool RideRecorder::flush() {
+    if (fill == 0 && !rollPending) {
+        return true;
+    }
+    const uint16_t split = rollPending ? rollAt : fill;
+    bool ok = writeSegment(buffer, split);
+    if (rollPending) {
+        rollPending = false;
+        segmentNo++;
+        segmentStartMs = rollStartMs;
+        segmentIndexed = false;
+        ok = writeSegment(buffer + split, fill - split) && ok;
+    }
+    fill = 0;
+    lastFlushTime = millis();
+    while (archiveBytes > RIDE_ARCHIVE_MAX_BYTES && pruneOldest()) {
+    }
+    return ok;
+}
+
+// 删除最早的一次骑行；只剩本次骑行时删除它最早的一个段（正在写入的段除外）。无可删除时返回 false
+bool RideRecorder::pruneOldest() {
+    File idx = LittleFS.open(RIDE_INDEX_PATH, "r");
+    if (!idx) {
+        return false;
+    }
+    RideSegmentInfo e;
+    if (idx.read((uint8_t *) &e, sizeof(e)) != sizeof(e) || (e.ride == rideId && e.segment == segmentNo)) {
+        idx.close();
+        return false;
+    }
+    const uint16_t oldest = e.ride;
+    const bool current = oldest == rideId;
+    const uint16_t oldestSegment = e.segment;
+    File tmp = LittleFS.open(RIDE_INDEX_TMP_PATH, "w");
+    if (!tmp) {
+        idx.close();
+        return false;
+    }
+    idx.seek(0, SeekSet);
+    char path[32];
+    while (idx.read((uint8_t *) &e, sizeof(e)) == sizeof(e)) {
+        if (e.ride != oldest || (current && e.segment != oldestSegment)) {
+            tmp.write((const uint8_t *) &e, sizeof(e));
+            continue;
+        }
+        segmentPath(path, sizeof(path), e.ride, e.segment);
+        File seg = LittleFS.open(path, "r");
+        if (seg) {
+            archiveBytes -= min((uint32_t) seg.size(), archiveBytes);
+            seg.close();
+        }
+        LittleFS.remove(path);
+        archiveBytes -= min((uint32_t) sizeof(e), archiveBytes);
+    }
+    idx.close();
+    tmp.close();
+    return LittleFS.rename(RIDE_INDEX_TMP_PATH, RIDE_INDEX_PATH);
+}
+
+void RideRecorder::loop(bool idle) {
+    if (!ready) {
+        // 运行中通过网页开启记录：目录扫描涉及文件系统，等音频空闲时再做
+        if (idle) {
+            begin();
+        }
+        return;
+    }
+    if (!idle) {
+        return;
+    }
+    const bool due = fill > 0 && millis() - lastFlushTime >= RIDE_FLUSH_INTERVAL_MS;
+    if (rollPending || fill >= RIDE_BUFFER_SIZE / 2 || due) {
+        flush();
+    }
+}
+
+void RideRecorder::writeRideListJson(Print &out) {
+    out.print('[');
+    File idx = LittleFS.open(RIDE_INDEX_PATH, "r");
+    if (idx) {
+        RideSegmentInfo e;
+        bool open = false;
+        uint16_t ride = 0;
+        uint16_t segments = 0;
+        uint32_t bytes = 0;
+        char path[32];
+        // 索引按骑行顺序追加，相邻条目归并为一次骑行
+        while (true) {
+            const bool more = idx.read((uint8_t *) &e, sizeof(e)) == sizeof(e);
+            if (open && (!more || e.ride != ride)) {
+                out.print("{\"ride\":");
+                out.print(ride);
+                out.print(",\"segments\":");
+                out.print(segments);
+                out.print(",\"bytes\":");
+                out.print(bytes);
+                out.print('}');
+                if (more) {
+                    out.print(',');
+                }
+                open = false;
+            }
+            if (!more) {
+                break;
+            }
+            if (!open) {
+                open = true;
+                ride = e.ride;
+                segments = 0;
+                bytes = 0;
+            }
+            segments++;
+            segmentPath(path, sizeof(path), e.ride, e.segment);
+            File seg = LittleFS.open(path, "r");
+            if (seg) {
+                bytes += seg.size();
+                seg.close();
+            }
+        }
+        idx.close();
+    }
+    out.print(']');
+}
+
+RideExport::RideExport(uint16_t ride, uint32_t fromMs) {
+    this->ride = ride;
+    this->fromMs = fromMs;
+    segment = 0;
+    bufLen = 0;
+    bufPos = 0;
+    t = 0;
+    track = 0;
+    distance = 0;
+    speed = 0;
+    angle = 0;
+    lineLen = (uint8_t) snprintf(line, sizeof(line), "timeMs,track,distance,speed,angle\n");
+    linePos = 0;
+    // 通过索引定位：起始时间不晚于 fromMs 的最后一个段
+    bool any = false;
+    File idx = LittleFS.open(RIDE_INDEX_PATH, "r");
+    if (idx) {
+        RideSegmentInfo e;
+        while (idx.read((uint8_t *) &e, sizeof(e)) == sizeof(e)) {
+            if (e.ride != ride) {
+                continue;
+            }
+            if (!any || e.startMs <= fromMs) {
+                segment = e.segment;
+            }
+            any = true;
+        }
+        idx.close();
+    }
+    done = !any || !openSegment(segment);
+}
+
+bool RideExport::openSegment(uint16_t segmentNo) {
+    File idx = LittleFS.open(RIDE_INDEX_PATH, "r");
+    if (!idx) {
+        return false;
+    }
+    RideSegmentInfo e;
+    bool found = false;
+    while (idx.read((uint8_t *) &e, sizeof(e)) == sizeof(e)) {
+        if (e.ride == ride && e.segment == segmentNo) {
+            found = true;
+            break;
+        }
+    }
+    idx.close();
+    if (!found) {
+        return false;
+    }
+    char path[32];
+    RideRecorder::segmentPath(path, sizeof(path), ride, segmentNo);
+    seg = LittleFS.open(path, "r");
+    if (!seg) {
+        return false;
+    }
+    segment = segmentNo;
+    t = e.startMs;
+    bufLen = 0;
+    bufPos = 0;
+    return true;
+}
+
+bool RideExport::readByte(uint8_t &b) {
+    if (bufPos >= bufLen) {
+        if (!seg) {
+            return false;
+        }
+        bufLen = seg.read(buf, sizeof(buf));
+        bufPos = 0;
+        if (bufLen == 0) {
+            return false;
+        }
+    }
+    b = buf[bufPos++];
+    return true;
+}
+
+bool RideExport::readVarint(uint32_t &v) {
+    v = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        uint8_t b;
+        if (!readByte(b)) {
+            return false;
+        }
+        v |= (uint32_t) (b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RideExport::nextLine() {
+    while (true) {
+        uint32_t head;
+        if (!readVarint(head)) {
+            // 当前段结束，继续下一段
+            seg.close();
+            if (!openSegment(segment + 1)) {
+                return false;
+            }
+            continue;
+        }
+        t += (head >> 2) * 10;
+        uint32_t a;
+        uint32_t b;
+        uint32_t c;
+        if (head & 1) {
+            uint32_t id;
+            if (!readVarint(id) || !readVarint(a) || !readVarint(b) || !readVarint(c)) {
+                return false;
+            }
+            track = (uint16_t) id;
+            distance = (uint8_t) a;
+            speed = (uint8_t) b;
+            angle = (int8_t) zigzagDecode(c);
+        } else {
+            if (!readVarint(a) || !readVarint(b) || !readVarint(c)) {
+                return false;
+            }
+            distance = (uint8_t) (distance + zigzagDecode(a));
+            speed = (uint8_t) (speed + zigzagDecode(b));
+            angle = (int8_t) (angle + zigzagDecode(c));
+        }
+        if (t < fromMs) {
+            continue;
+        }
+        lineLen = (uint8_t) snprintf(line, sizeof(line), "%lu,%u,%u,%u,%d\n", (unsigned long) t,
+                                     (unsigned) track, (unsigned) distance, (unsigned) speed, (int) angle);
+        linePos = 0;
+        return true;
+    }
+}
+
+size_t RideExport::fill(uint8_t *out, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen) {
+        if (linePos >= lineLen) {
+            if (done || !nextLine()) {
+                done = true;
+                break;
+            }
+        }
+        size_t k = lineLen - linePos;
+        if (k > maxLen - n) {
+            k = maxLen - n;
+        }
+        memcpy(out + n, line + linePos, k);
+        n += k;
+        linePos += k;
+    }
+    return n;
+}
@@ -0,0 +1,113 @@
+#ifndef RIDE_RECORDER_H
+#define RIDE_RECORDER_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#define RIDE_DIR "/rides"
+#define RIDE_INDEX_PATH "/rides/index.bin"
+#define RIDE_SEGMENT_SIZE 4096          // 单个段文件上限
+#define RIDE_BUFFER_SIZE 256            // 内存缓冲，由 loop 在空闲时追加写入当前段
+#define RIDE_RECORD_MAX 24              // 单条记录最大字节数
+#define RIDE_ARCHIVE_MAX_BYTES 262144UL // 轨迹存档总量上限，超出后删除最早的骑行，只剩本次骑行时删除其最早的段
+
+// 段索引条目，段文件首次写入数据后追加到 /rides/index.bin，用于按骑行与时间快速定位段文件
+struct RideSegmentInfo {
+    uint16_t ride;
+    uint16_t segment;
+    uint32_t startMs;   // 段内首条记录相对开机的时间
+};
+
+// 骑行轨迹记录器：每帧最近目标按 delta + zigzag varint 编码，写入只追加的段文件
+// 记录格式：varint(dt/10ms << 2 | 新轨迹 << 1 | 绝对值)，
+//   绝对值记录随后为 varint(轨迹号) varint(距离) varint(速度) zigzag(角度)，
+//   否则为 zigzag(距离差) zigzag(速度差) zigzag(角度差)；每个段以绝对值记录开头，可独立解码
+class RideRecorder {
+private:
+    uint16_t rideId;
+    uint16_t segmentNo;
+    bool ready;         // 已建目录并确定本次骑行编号
+    bool started;
+    uint32_t segmentBytes;
+    uint32_t archiveBytes;
+    uint32_t segmentStartMs;
+    bool segmentIndexed;    // 当前段已写入索引
+    uint8_t buffer[RIDE_BUFFER_SIZE];
+    uint16_t fill;
+    unsigned long lastFlushTime;
+
+    // 段写满时记录切换点，由下一次 flush 把此前的字节写入旧段、其余写入新段
+    bool rollPending;
+    uint16_t rollAt;
+    uint32_t rollStartMs;
+
+    bool hasPrev;
+    bool keyNext;
+    uint32_t prevTime;
+    uint8_t prevDistance;
+    uint8_t prevSpeed;
+    int8_t prevAngle;
+    uint16_t trackId;
+
+    void putVarint(uint32_t v);
+
+    void startSegment(uint32_t nowMs);
+
+    bool writeSegment(const uint8_t *data, uint16_t len);
+
+    bool flush();
+
+    bool pruneOldest();
+
+public:
+    RideRecorder();
+
+    // 建目录、由索引确定本次骑行编号并统计存档大小；开机时未开启记录则在运行中开启后由 loop 补做
+    void begin();
+
+    // 只编码到内存缓冲，不访问文件系统；未完成 begin 或缓冲已满时丢弃本帧
+    void recordFrame(uint8_t distance, uint8_t speed, int8_t angle);
+
+    // 在主循环中调用，idle 为 true（无音频播放）时补做 begin，并在缓冲过半、段切换或定时到达时落盘
+    void loop(bool idle);
+
+    static void segmentPath(char *out, size_t size, uint16_t ride, uint16_t segment);
+
+    static void writeRideListJson(Print &out);
+};
+
+// 按需解码某次骑行的段文件，逐块输出 CSV，供分块 HTTP 响应使用
+class RideExport {
+private:
+    uint16_t ride;
+    uint16_t segment;
+    uint32_t fromMs;
+    File seg;
+    uint8_t buf[128];
+    uint16_t bufLen;
+    uint16_t bufPos;
+    char line[48];
+    uint8_t lineLen;
+    uint8_t linePos;
+    uint32_t t;
+    uint16_t track;
+    uint8_t distance;
+    uint8_t speed;
+    int8_t angle;
+    bool done;
+
+    bool openSegment(uint16_t segmentNo);
+
+    bool readByte(uint8_t &b);
+
+    bool readVarint(uint32_t &v);
+
+    bool nextLine();
+
+public:
+    RideExport(uint16_t ride, uint32_t fromMs);
+
+    size_t fill(uint8_t *out, size_t maxLen);
+};
+
+#endif // RIDE_RECORDER_H
@@ -0,0 +1,57 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <Arduino.h>
+
+// 单生产者/单消费者环形队列：生产者只写 head，消费者只写 tail，无需关中断或加锁。
+// N 须为 2 的幂，最多同时容纳 N-1 项
+template<typename T, uint8_t N>
+class SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "队列长度须为 2 的幂");
+
+private:
+    T items[N];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+
+public:
+    SpscQueue() {
+        head = 0;
+        tail = 0;
+    }
+
+    // 生产者：先写入槽位，再发布 head；队列满时返回 false
+    bool push(const T &item) {
+        const uint8_t h = head;
+        const uint8_t next = (h + 1) & (N - 1);
+        if (next == tail) {
+            return false;
+        }
+        items[h] = item;
+        __sync_synchronize();
+        head = next;
+        return true;
+    }
+
+    // 消费者：取队首但不出队，处理完成后再 pop 释放槽位
+    T *peek() {
+        const uint8_t t = tail;
+        if (t == head) {
+            return nullptr;
+        }
+        __sync_synchronize();
+        return &items[t];
+    }
+
+    void pop() {
+        __sync_synchronize();
+        tail = (tail + 1) & (N - 1);
+    }
+
+    // 按下标访问全部槽位（含空闲槽），只用于生产者一侧的单字撤销写入
+    T &slotAt(uint8_t index) {
+        return items[index];
+    }
+};
+
+#endif // SPSC_QUEUE_H
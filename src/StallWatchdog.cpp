@@ -0,0 +1,248 @@
+#include "StallWatchdog.h"
+
+static const char *const PHASE_NAMES[PHASE_COUNT] = {
+    "idle", "audio", "sensors", "audioStart", "logFlush", "lights", "stats", "rides", "web", "button"
+};
+
+static const char *const STALL_KIND_NAMES[] = {"slow", "wdt", "softWdt", "exception"};
+
+// 崩溃回调没有参数可以传递对象，begin 时登记
+static StallWatchdog *crashWatchdog = nullptr;
+
+// ESP8266 core 在异常与软件看门狗复位前调用的弱符号回调
+extern "C" void custom_crash_callback(struct rst_info *info, uint32_t stack, uint32_t stackEnd) {
+    (void) info;
+    if (crashWatchdog != nullptr) {
+        crashWatchdog->captureCrash(stack, stackEnd);
+    }
+}
+
+// IRAM 与 flash 映射的代码区
+static inline bool isCodeAddress(uint32_t v) {
+    return (v >= 0x40100000 && v < 0x40108000) || (v >= 0x40201000 && v < 0x40300000);
+}
+
+StallWatchdog::StallWatchdog() {
+    memset(&state, 0, sizeof(state));
+    resetReason = 0;
+    phase = PHASE_IDLE;
+    phaseSite = 0;
+    passStartUs = 0;
+    phaseStartUs = 0;
+    slowPhase = PHASE_IDLE;
+    slowPhaseUs = 0;
+    slowSite = 0;
+    maxPassUs = 0;
+    stallCount = 0;
+    frameSeq = 0;
+}
+
+void StallWatchdog::writeRtc(const void *field, size_t size) {
+    const size_t offset = (const uint8_t *) field - (const uint8_t *) &state;
+    ESP.rtcUserMemoryWrite(STALL_RTC_OFFSET + offset / 4, (uint32_t *) field, size);
+}
+
+void StallWatchdog::begin() {
+    ESP.rtcUserMemoryRead(STALL_RTC_OFFSET, (uint32_t *) &state, sizeof(state));
+    // 上电后 RTC 内容随机，校验不过时整体清零
+    if (state.magic != STALL_RTC_MAGIC || state.head >= STALL_RECORD_MAX || state.count > STALL_RECORD_MAX) {
+        memset(&state, 0, sizeof(state));
+        state.magic = STALL_RTC_MAGIC;
+    }
+    const rst_info *info = ESP.getResetInfoPtr();
+    resetReason = (uint8_t) info->reason;
+    int kind = -1;
+    if (info->reason == REASON_WDT_RST) {
+        kind = STALL_WDT_RESET;
+    } else if (info->reason == REASON_SOFT_WDT_RST) {
+        kind = STALL_SOFT_WDT_RESET;
+    } else if (info->reason == REASON_EXCEPTION_RST) {
+        kind = STALL_EXCEPTION_RESET;
+    }
+    if (kind >= 0) {
+        StallRecord r;
+        memset(&r, 0, sizeof(r));
+        r.boot = state.bootCount;
+        r.uptimeMs = state.liveFrameMs;
+        r.frameSeq = state.liveFrameSeq;
+        r.site = state.liveSite;
+        r.epc1 = info->epc1;
+        r.kind = (uint8_t) kind;
+        r.phase = state.livePhase < PHASE_COUNT ? (uint8_t) state.livePhase : (uint8_t) PHASE_IDLE;
+        r.exccause = (uint8_t) info->exccause;
+        addRecord(r);
+    }
+    state.bootCount++;
+    state.livePhase = PHASE_IDLE;
+    state.liveSite = 0;
+    state.liveFrameSeq = 0;
+    state.liveFrameMs = 0;
+    writeRtc(&state, sizeof(state));
+    crashWatchdog = this;
+}
+
+void StallWatchdog::captureCrash(uint32_t stack, uint32_t stackEnd) {
+    StallCrashStack &c = state.crash;
+    c.boot = state.bootCount;
+    c.words = 0;
+    const uint32_t *p = (const uint32_t *) (uintptr_t) stack;
+    const uint32_t *end = (const uint32_t *) (uintptr_t) stackEnd;
+    for (uint16_t i = 0; i < STALL_STACK_SCAN_WORDS && p < end && c.words < STALL_STACK_WORDS; i++, p++) {
+        if (isCodeAddress(*p)) {
+            c.addrs[c.words++] = *p;
+        }
+    }
+    writeRtc(&state.crash, sizeof(state.crash));
+}
+
+void StallWatchdog::addRecord(const StallRecord &r) {
+    state.records[state.head] = r;
+    writeRtc(&state.records[state.head], sizeof(StallRecord));
+    state.head = (state.head + 1) % STALL_RECORD_MAX;
+    if (state.count < STALL_RECORD_MAX) {
+        state.count++;
+    }
+    // head 与 count 共用一个字
+    writeRtc(&state.head, 4);
+}
+
+void StallWatchdog::closePhase(unsigned long now) {
+    const uint32_t dt = now - phaseStartUs;
+    if (phase != PHASE_IDLE && dt > slowPhaseUs) {
+        slowPhaseUs = dt;
+        slowPhase = phase;
+        slowSite = phaseSite;
+    }
+}
+
+void StallWatchdog::beginPass() {
+    const unsigned long now = micros();
+    passStartUs = now;
+    phaseStartUs = now;
+    phase = PHASE_IDLE;
+    slowPhase = PHASE_IDLE;
+    slowPhaseUs = 0;
+    slowSite = 0;
+}
+
+LoopPhase StallWatchdog::enter(LoopPhase next) {
+    const unsigned long now = micros();
+    closePhase(now);
+    const LoopPhase prev = phase;
+    phase = next;
+    phaseStartUs = now;
+    phaseSite = (uint32_t) (uintptr_t) __builtin_return_address(0);
+    state.livePhase = next;
+    state.liveSite = phaseSite;
+    writeRtc(&state.livePhase, 8);
+    return prev;
+}
+
+void StallWatchdog::endPass() {
+    const unsigned long now = micros();
+    closePhase(now);
+    const uint32_t passUs = now - passStartUs;
+    if (passUs > maxPassUs) {
+        maxPassUs = passUs;
+    }
+    if (passUs > STALL_THRESHOLD_MS * 1000UL) {
+        stallCount++;
+        StallRecord r;
+        memset(&r, 0, sizeof(r));
+        r.boot = state.bootCount;
+        r.uptimeMs = millis();
+        r.passUs = passUs;
+        r.phaseUs = slowPhaseUs;
+        r.freeHeap = ESP.getFreeHeap();
+        r.frameSeq = frameSeq;
+        r.site = slowSite;
+        r.kind = STALL_SLOW_PASS;
+        r.phase = slowPhase;
+        addRecord(r);
+    }
+    phase = PHASE_IDLE;
+    state.livePhase = PHASE_IDLE;
+    state.liveSite = 0;
+    writeRtc(&state.livePhase, 8);
+}
+
+void StallWatchdog::noteFrame() {
+    frameSeq++;
+    state.liveFrameSeq = frameSeq;
+    state.liveFrameMs = millis();
+    writeRtc(&state.liveFrameSeq, 8);
+}
+
+void StallWatchdog::clear() {
+    state.head = 0;
+    state.count = 0;
+    memset(state.records, 0, sizeof(state.records));
+    stallCount = 0;
+    maxPassUs = 0;
+    writeRtc(&state, sizeof(state));
+}
+
+void StallWatchdog::writeJson(Print &out) const {
+    out.print("{\"bootCount\":");
+    out.print(state.bootCount);
+    out.print(",\"resetReason\":");
+    out.print(resetReason);
+    out.print(",\"resetInfo\":\"");
+    out.print(ESP.getResetReason());
+    out.print('"');
+    out.print(",\"thresholdMs\":");
+    out.print(STALL_THRESHOLD_MS);
+    out.print(",\"maxPassUs\":");
+    out.print(maxPassUs);
+    out.print(",\"stalls\":");
+    out.print(stallCount);
+    out.print(",\"frameSeq\":");
+    out.print(frameSeq);
+    out.print(",\"records\":[");
+    // 从最旧到最新输出
+    const uint8_t first = (state.head + STALL_RECORD_MAX - state.count) % STALL_RECORD_MAX;
+    for (uint8_t i = 0; i < state.count; i++) {
+        const StallRecord &r = state.records[(first + i) % STALL_RECORD_MAX];
+        if (i > 0) {
+            out.print(',');
+        }
+        out.print("{\"boot\":");
+        out.print(r.boot);
+        out.print(",\"kind\":\"");
+        out.print(r.kind <= STALL_EXCEPTION_RESET ? STALL_KIND_NAMES[r.kind] : "?");
+        out.print("\",\"phase\":\"");
+        out.print(r.phase < PHASE_COUNT ? PHASE_NAMES[r.phase] : "?");
+        out.print("\",\"uptimeMs\":");
+        out.print(r.uptimeMs);
+        out.print(",\"passUs\":");
+        out.print(r.passUs);
+        out.print(",\"phaseUs\":");
+        out.print(r.phaseUs);
+        out.print(",\"freeHeap\":");
+        out.print(r.freeHeap);
+        out.print(",\"frameSeq\":");
+        out.print(r.frameSeq);
+        out.print(",\"site\":\"0x");
+        out.print(r.site, HEX);
+        out.print("\",\"epc1\":\"0x");
+        out.print(r.epc1, HEX);
+        out.print("\",\"exccause\":");
+        out.print(r.exccause);
+        // 崩溃快照只保留最近一次，对应同一次启动的异常或软件看门狗记录
+        const StallCrashStack &c = state.crash;
+        if ((r.kind == STALL_SOFT_WDT_RESET || r.kind == STALL_EXCEPTION_RESET) && r.boot == c.boot && c.words > 0) {
+            out.print(",\"stack\":[");
+            for (uint8_t j = 0; j < c.words && j < STALL_STACK_WORDS; j++) {
+                if (j > 0) {
+                    out.print(',');
+                }
+                out.print("\"0x");
+                out.print(c.addrs[j], HEX);
+                out.print('"');
+            }
+            out.print(']');
+        }
+        out.print('}');
+    }
+    out.print("]}");
+}
@@ -0,0 +1,147 @@
+#ifndef STALL_WATCHDOG_H
+#define STALL_WATCHDOG_H
+
+#include <Arduino.h>
+
+#define STALL_RTC_MAGIC 0x53544C32      // "STL2"
+#define STALL_RTC_OFFSET 32             // RTC 用户内存块偏移（4 字节/块），前 128 字节留给 OTA 的 eboot 命令
+#define STALL_RECORD_MAX 8              // RTC 中保留的最近记录数，环形覆盖
+#define STALL_STACK_WORDS 12            // 崩溃时保存的栈上代码地址数
+#define STALL_STACK_SCAN_WORDS 256      // 崩溃时从栈顶向下最多扫描的字数
+#ifndef STALL_THRESHOLD_MS
+#define STALL_THRESHOLD_MS 50           // 主循环单轮超过此耗时即记录
+#endif
+
+// 主循环阶段，按执行顺序排列；嵌套阶段（日志落盘、音效启动）结束后恢复外层阶段
+enum LoopPhase : uint8_t {
+    PHASE_IDLE,
+    PHASE_AUDIO,                // 音频解码
+    PHASE_SENSORS,              // 雷达解析与预警判断
+    PHASE_AUDIO_START,          // 打开音效文件并启动解码
+    PHASE_LOG_FLUSH,            // 日志落盘
+    PHASE_LIGHTS,
+    PHASE_STATS,
+    PHASE_RIDES,
+    PHASE_WEB,
+    PHASE_BUTTON,
+    PHASE_COUNT
+};
+
+enum StallKind : uint8_t {
+    STALL_SLOW_PASS,            // 单轮超时，复位前正常记录
+    STALL_WDT_RESET,            // 硬件看门狗复位
+    STALL_SOFT_WDT_RESET,       // 软件看门狗复位
+    STALL_EXCEPTION_RESET       // 异常复位
+};
+
+struct StallRecord {
+    uint32_t boot;              // 发生时的启动序号（从 1 开始）
+    uint32_t uptimeMs;          // 复位记录为复位前最后一帧雷达数据的时间
+    uint32_t passUs;            // 整轮耗时，复位记录为 0
+    uint32_t phaseUs;           // 最慢阶段耗时，复位记录为 0
+    uint32_t freeHeap;          // 复位记录为 0
+    uint32_t frameSeq;          // 最近一帧雷达数据的序号
+    uint32_t site;              // 阶段入口的返回地址，可用 addr2line 对照固件
+    uint32_t epc1;              // 复位记录的异常 PC，单轮超时为 0
+    uint8_t kind;
+    uint8_t phase;
+    uint8_t exccause;
+    uint8_t reserved;
+};
+
+// 软件看门狗与异常复位前由 custom_crash_callback 保存的栈快照：从栈顶向下挑出像代码地址的字
+// （多为调用链上的返回地址），可用 addr2line 对照固件；硬件看门狗复位没有回调，不会有快照
+struct StallCrashStack {
+    uint32_t boot;              // 崩溃所在的启动序号，与复位记录对应
+    uint32_t words;             // 有效地址数
+    uint32_t addrs[STALL_STACK_WORDS];
+};
+
+// RTC 用户内存中的完整布局；live* 字段在运行中持续更新，看门狗复位后据此还原复位前所处阶段
+struct StallRtcState {
+    uint32_t magic;
+    uint32_t bootCount;
+    uint8_t head;               // 下一条记录的写入位置
+    uint8_t count;
+    uint16_t reserved;
+    uint32_t livePhase;
+    uint32_t liveSite;
+    uint32_t liveFrameSeq;
+    uint32_t liveFrameMs;
+    StallRecord records[STALL_RECORD_MAX];
+    StallCrashStack crash;
+};
+
+static_assert(sizeof(StallRtcState) % 4 == 0 && STALL_RTC_OFFSET * 4 + sizeof(StallRtcState) <= 512,
+              "RTC 用户内存只有 512 字节，按 4 字节块访问");
+
+// 主循环卡顿检测：记录每个阶段的起始时间，单轮超时或看门狗复位时把现场写入 RTC 用户内存，复位后仍可读取
+class StallWatchdog {
+private:
+    StallRtcState state;        // RTC 内容的内存镜像
+    uint8_t resetReason;
+    LoopPhase phase;
+    uint32_t phaseSite;
+    unsigned long passStartUs;
+    unsigned long phaseStartUs;
+    // 本轮最慢的阶段
+    LoopPhase slowPhase;
+    uint32_t slowPhaseUs;
+    uint32_t slowSite;
+    uint32_t maxPassUs;         // 本次启动以来最长的一轮
+    uint32_t stallCount;        // 本次启动以来的超时轮数
+    uint32_t frameSeq;
+
+    // 只写入镜像中 field 开始的 size 字节，两者都须 4 字节对齐
+    void writeRtc(const void *field, size_t size);
+
+    void addRecord(const StallRecord &r);
+
+    void closePhase(unsigned long now);
+
+public:
+    StallWatchdog();
+
+    // 启动时调用：读取 RTC，上次为看门狗或异常复位时把复位前的阶段转存为一条记录
+    void begin();
+
+    // 主循环每轮开头调用
+    void beginPass();
+
+    // 切换到新阶段并返回之前的阶段；写入 RTC 的只有阶段与入口地址两个字
+    LoopPhase enter(LoopPhase next) __attribute__((noinline));
+
+    // 主循环每轮末尾调用，超过 STALL_THRESHOLD_MS 时记录本轮最慢阶段
+    void endPass();
+
+    // 每收到一轮雷达数据调用一次
+    void noteFrame();
+
+    void clear();
+
+    void writeJson(Print &out) const;
+
+    // 崩溃回调中调用：扫描 [stack, stackEnd) 并把快照直接写入 RTC
+    void captureCrash(uint32_t stack, uint32_t stackEnd);
+};
+
+// 在作用域内切换到指定阶段，离开时恢复外层阶段；watchdog 为空时不做任何事
+class StallPhaseScope {
+private:
+    StallWatchdog *watchdog;
+    LoopPhase prev;
+
+public:
+    __attribute__((always_inline)) StallPhaseScope(StallWatchdog *watchdog, LoopPhase phase) {
+        this->watchdog = watchdog;
+        prev = watchdog != nullptr ? watchdog->enter(phase) : PHASE_IDLE;
+    }
+
+    ~StallPhaseScope() {
+        if (watchdog != nullptr) {
+            watchdog->enter(prev);
+        }
+    }
+};
+
+#endif // STALL_WATCHDOG_H
@@ -0,0 +1,65 @@
+#include "Telemetry.h"
+
+Telemetry::Telemetry() {
+    active = false;
+    station = false;
+    port = 0;
+    lastLoopUs = 0;
+}
+
+void Telemetry::begin(const RadarConfig &cfg) {
+    if (!cfg.telemetryEnabled) {
+        return;
+    }
+    port = (uint16_t) cfg.telemetryPort;
+    station = cfg.telemetrySsid[0] != '\0';
+    if (station) {
+        WiFi.mode(WIFI_STA);
+        WiFi.setAutoReconnect(true);
+        WiFi.begin(cfg.telemetrySsid, cfg.telemetryPassword);
+    } else {
+        WiFi.mode(WIFI_AP);
+        WiFi.softAP("Radar");
+    }
+    // 关闭调制解调器休眠，否则每包会被延迟到下一个 DTIM 周期（约 100ms 以上）
+    WiFi.setSleepMode(WIFI_NONE_SLEEP);
+    active = true;
+    lastLoopUs = micros();
+}
+
+bool Telemetry::isActive() const {
+    return active;
+}
+
+bool Telemetry::isStation() const {
+    return station;
+}
+
+void Telemetry::loopTick() {
+    if (!active) {
+        return;
+    }
+    const unsigned long now = micros();
+    packet.addLoop(now - lastLoopUs);
+    lastLoopUs = now;
+}
+
+void Telemetry::sendFrame(const RadarTarget *targets, uint8_t count, uint8_t sensorMask, uint8_t alert) {
+    if (!active) {
+        return;
+    }
+    if (station && WiFi.status() != WL_CONNECTED) {
+        return;
+    }
+    const size_t len = packet.build(millis(), targets, count, sensorMask, alert);
+    IPAddress dest;
+    if (station) {
+        dest = WiFi.broadcastIP();
+    } else {
+        dest = WiFi.softAPIP();
+        dest[3] = 255;
+    }
+    udp.beginPacket(dest, port);
+    udp.write(packet.bytes(), len);
+    udp.endPacket();
+}
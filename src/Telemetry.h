@@ -0,0 +1,36 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#include "ConfigManager.h"
+#include "TelemetryPacket.h"
+
+// 遥测：关闭时不占用 WiFi；包由 TelemetryPacket 在预分配缓冲中拼装，不使用 String
+class Telemetry {
+private:
+    WiFiUDP udp;
+    bool active;
+    bool station;
+    uint16_t port;
+    TelemetryPacket packet;
+    unsigned long lastLoopUs;
+
+public:
+    Telemetry();
+
+    // 按配置启动 WiFi：填写了 SSID 时连接路由器，否则开启与配置模式相同的热点；向所在网段广播
+    void begin(const RadarConfig &cfg);
+
+    bool isActive() const;
+
+    bool isStation() const;
+
+    // 在主循环每轮开头调用，统计循环耗时
+    void loopTick();
+
+    void sendFrame(const RadarTarget *targets, uint8_t count, uint8_t sensorMask, uint8_t alert);
+};
+
+#endif // TELEMETRY_H
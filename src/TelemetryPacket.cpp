@@ -0,0 +1,51 @@
+#include "TelemetryPacket.h"
+
+TelemetryPacket::TelemetryPacket() {
+    seq = 0;
+    memset(data, 0, sizeof(data));
+    loopSumUs = 0;
+    loopMaxUs = 0;
+    loopCount = 0;
+}
+
+void TelemetryPacket::addLoop(uint32_t dtUs) {
+    loopSumUs += dtUs;
+    if (dtUs > loopMaxUs) {
+        loopMaxUs = dtUs;
+    }
+    if (loopCount < 0xFFFF) {
+        loopCount++;
+    }
+}
+
+size_t TelemetryPacket::build(uint32_t timeMs, const RadarTarget *targets, uint8_t count, uint8_t sensorMask,
+                              uint8_t alert) {
+    if (count > TELEMETRY_MAX_TARGETS) {
+        count = TELEMETRY_MAX_TARGETS;
+    }
+    TelemetryHeader h;
+    h.magic = TELEMETRY_MAGIC;
+    h.version = TELEMETRY_VERSION;
+    h.targetCount = count;
+    h.seq = seq++;
+    h.timeMs = timeMs;
+    h.alert = alert;
+    h.sensorMask = sensorMask;
+    h.loopCount = loopCount;
+    const uint32_t avgUs = loopCount > 0 ? loopSumUs / loopCount : 0;
+    h.loopAvgUs = (uint16_t) (avgUs > 0xFFFF ? 0xFFFF : avgUs);
+    h.loopMaxUs = (uint16_t) (loopMaxUs > 0xFFFF ? 0xFFFF : loopMaxUs);
+    memcpy(data, &h, sizeof(h));
+    TelemetryTarget *out = (TelemetryTarget *) (data + sizeof(h));
+    for (uint8_t i = 0; i < count; i++) {
+        out[i].sensor = targets[i].sensor;
+        out[i].approaching = targets[i].approaching ? 1 : 0;
+        out[i].distance = targets[i].distance;
+        out[i].speed = targets[i].speed;
+        out[i].angle = targets[i].angle;
+    }
+    loopSumUs = 0;
+    loopMaxUs = 0;
+    loopCount = 0;
+    return sizeof(h) + count * sizeof(TelemetryTarget);
+}
@@ -0,0 +1,66 @@
+#ifndef TELEMETRY_PACKET_H
+#define TELEMETRY_PACKET_H
+
+#include <Arduino.h>
+#include "RadarSensor.h"
+
+#define TELEMETRY_MAGIC 0x5452          // "RT"（小端）
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_MAX_TARGETS 24        // 单包最多携带的目标数，超出部分截断
+
+// 告警状态位（TelemetryHeader::alert）
+#define TELEMETRY_ALERT_LEFT 0x01
+#define TELEMETRY_ALERT_RIGHT 0x02
+#define TELEMETRY_ALERT_DANGER 0x04
+#define TELEMETRY_ALERT_AUDIO 0x08
+
+// UDP 包格式（小端、紧凑排列）：包头 + targetCount 个目标，每个雷达帧发送一包
+struct __attribute__((packed)) TelemetryHeader {
+    uint16_t magic;
+    uint8_t version;
+    uint8_t targetCount;
+    uint32_t seq;               // 包序号，接收端据此判断丢包
+    uint32_t timeMs;            // 设备 millis()
+    uint8_t alert;              // TELEMETRY_ALERT_* 位
+    uint8_t sensorMask;         // 本包包含新帧的传感器位图
+    uint16_t loopCount;         // 自上一包以来主循环次数
+    uint16_t loopAvgUs;         // 期间主循环平均耗时
+    uint16_t loopMaxUs;         // 期间主循环最长耗时（饱和到 65535）
+};
+
+struct __attribute__((packed)) TelemetryTarget {
+    uint8_t sensor;
+    uint8_t approaching;
+    uint8_t distance;           // 米
+    uint8_t speed;              // km/h
+    int8_t angle;               // 车身坐标系，负值为左
+};
+
+static_assert(sizeof(TelemetryHeader) == 20 && sizeof(TelemetryTarget) == 5, "遥测包格式变化需同步 TELEMETRY_VERSION 与接收端");
+
+#define TELEMETRY_PACKET_MAX (sizeof(TelemetryHeader) + TELEMETRY_MAX_TARGETS * sizeof(TelemetryTarget))
+
+// 遥测包拼装：累计两包之间的主循环耗时，并在预分配缓冲中写入包头与目标，不涉及 WiFi
+class TelemetryPacket {
+private:
+    uint32_t seq;
+    uint8_t data[TELEMETRY_PACKET_MAX];
+
+    uint32_t loopSumUs;
+    uint32_t loopMaxUs;
+    uint16_t loopCount;
+
+public:
+    TelemetryPacket();
+
+    void addLoop(uint32_t dtUs);
+
+    // 拼装下一包并返回字节数，之后循环统计清零
+    size_t build(uint32_t timeMs, const RadarTarget *targets, uint8_t count, uint8_t sensorMask, uint8_t alert);
+
+    const uint8_t *bytes() const {
+        return data;
+    }
+};
+
+#endif // TELEMETRY_PACKET_H
@@ -0,0 +1,151 @@
+#include "TrafficStats.h"
+#include <LittleFS.h>
+
+#define STATS_MAGIC 0x53544132UL // "STA2"，结构变化时需同步修改
+
+static const char *STATS_FILE_PATH = "/stats.bin";
+static const unsigned long STATS_SAVE_INTERVAL_MS = 120000; // 有新数据时的落盘间隔
+
+static inline void saturatingInc(uint16_t &c) {
+    if (c != 0xFFFF) {
+        c++;
+    }
+}
+
+TrafficStats::TrafficStats() {
+    memset(&rec, 0, sizeof(rec));
+    rec.magic = STATS_MAGIC;
+    memset(rec.rideClosest, STATS_NO_APPROACH, sizeof(rec.rideClosest));
+    dirty = false;
+    lastSaveTime = 0;
+}
+
+void TrafficStats::begin() {
+    File f = LittleFS.open(STATS_FILE_PATH, "r");
+    if (f) {
+        TrafficStatsRecord loaded;
+        if (f.read((uint8_t *) &loaded, sizeof(loaded)) == sizeof(loaded) && loaded.magic == STATS_MAGIC) {
+            rec = loaded;
+        }
+        f.close();
+    }
+    // 新的骑行：历史最近距离后移一位
+    memmove(rec.rideClosest + 1, rec.rideClosest, STATS_RIDE_HISTORY - 1);
+    rec.rideClosest[0] = STATS_NO_APPROACH;
+    rec.rides++;
+    dirty = true;
+    lastSaveTime = millis();
+}
+
+void TrafficStats::recordApproach(uint8_t distance) {
+    if (distance < rec.rideClosest[0]) {
+        rec.rideClosest[0] = distance;
+        dirty = true;
+    }
+}
+
+void TrafficStats::recordTarget(uint8_t distance, uint8_t speed, int8_t angle, bool isDanger) {
+    uint8_t d = distance / STATS_DIST_BIN_M;
+    if (d >= STATS_DIST_BINS) {
+        d = STATS_DIST_BINS - 1;
+    }
+    uint8_t s = speed / STATS_SPEED_BIN_KMH;
+    if (s >= STATS_SPEED_BINS) {
+        s = STATS_SPEED_BINS - 1;
+    }
+    int a = (angle + STATS_ANGLE_SECTORS * STATS_ANGLE_SECTOR_DEG / 2) / STATS_ANGLE_SECTOR_DEG;
+    if (a < 0) {
+        a = 0;
+    } else if (a >= STATS_ANGLE_SECTORS) {
+        a = STATS_ANGLE_SECTORS - 1;
+    }
+    saturatingInc(rec.distSpeed[d][s]);
+    saturatingInc(rec.angle[a]);
+    rec.targets++;
+    rec.alerts[isDanger ? 1 : 0]++;
+    dirty = true;
+}
+
+void TrafficStats::loop(bool idle) {
+    if (!dirty || !idle) {
+        return;
+    }
+    const unsigned long now = millis();
+    if (now - lastSaveTime < STATS_SAVE_INTERVAL_MS) {
+        return;
+    }
+    lastSaveTime = now;
+    if (save()) {
+        dirty = false;
+    }
+}
+
+bool TrafficStats::save() {
+    File f = LittleFS.open(STATS_FILE_PATH, "w");
+    if (!f) {
+        return false;
+    }
+    const bool ok = f.write((const uint8_t *) &rec, sizeof(rec)) == sizeof(rec);
+    f.close();
+    return ok;
+}
+
+void TrafficStats::reset() {
+    const uint8_t closest = rec.rideClosest[0];
+    memset(&rec, 0, sizeof(rec));
+    rec.magic = STATS_MAGIC;
+    memset(rec.rideClosest, STATS_NO_APPROACH, sizeof(rec.rideClosest));
+    rec.rideClosest[0] = closest;
+    rec.rides = 1;
+    // 只清内存，由 loop 在下一次音频空闲时落盘，网页命令不必等待文件写入
+    dirty = true;
+    lastSaveTime = millis() - STATS_SAVE_INTERVAL_MS;
+}
+
+void TrafficStats::writeJson(Print &out) const {
+    out.print("{\"rides\":");
+    out.print(rec.rides);
+    out.print(",\"targets\":");
+    out.print(rec.targets);
+    out.print(",\"alerts\":{\"normal\":");
+    out.print(rec.alerts[0]);
+    out.print(",\"danger\":");
+    out.print(rec.alerts[1]);
+    out.print("},\"distBinM\":");
+    out.print(STATS_DIST_BIN_M);
+    out.print(",\"speedBinKmh\":");
+    out.print(STATS_SPEED_BIN_KMH);
+    out.print(",\"distSpeed\":[");
+    for (int d = 0; d < STATS_DIST_BINS; d++) {
+        out.print(d ? ",[" : "[");
+        for (int s = 0; s < STATS_SPEED_BINS; s++) {
+            if (s) {
+                out.print(',');
+            }
+            out.print(rec.distSpeed[d][s]);
+        }
+        out.print(']');
+    }
+    out.print("],\"angleSectorDeg\":");
+    out.print(STATS_ANGLE_SECTOR_DEG);
+    out.print(",\"angle\":[");
+    for (int a = 0; a < STATS_ANGLE_SECTORS; a++) {
+        if (a) {
+            out.print(',');
+        }
+        out.print(rec.angle[a]);
+    }
+    // 最近几次骑行的最近接近距离，null 表示该次无目标
+    out.print("],\"rideClosest\":[");
+    for (int i = 0; i < STATS_RIDE_HISTORY; i++) {
+        if (i) {
+            out.print(',');
+        }
+        if (rec.rideClosest[i] == STATS_NO_APPROACH) {
+            out.print("null");
+        } else {
+            out.print(rec.rideClosest[i]);
+        }
+    }
+    out.print("]}");
+}
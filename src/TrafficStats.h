@@ -0,0 +1,54 @@
+#ifndef TRAFFIC_STATS_H
+#define TRAFFIC_STATS_H
+
+#include <Arduino.h>
+
+#define STATS_DIST_BIN_M 10
+#define STATS_DIST_BINS 10          // 每 10m 一档，最后一档包含更远的目标
+#define STATS_SPEED_BIN_KMH 10
+#define STATS_SPEED_BINS 12         // 每 10km/h 一档，覆盖 0~120km/h
+#define STATS_ANGLE_SECTOR_DEG 4
+#define STATS_ANGLE_SECTORS 22      // 每 4° 一个扇区，覆盖车身坐标 -44°~44°（侧向雷达 30° + 视场 12°）
+#define STATS_RIDE_HISTORY 8        // 保留最近几次骑行的最近接近距离
+#define STATS_NO_APPROACH 0xFF
+
+// 持久化到 /stats.bin 的统计记录，全部为定长整数
+struct TrafficStatsRecord {
+    uint32_t magic;
+    uint32_t rides;                 // 开机次数即骑行次数
+    uint32_t targets;               // 触发预警的目标数
+    uint32_t alerts[2];             // 0: 普通预警, 1: 危险预警
+    uint16_t distSpeed[STATS_DIST_BINS][STATS_SPEED_BINS];
+    uint16_t angle[STATS_ANGLE_SECTORS];
+    uint8_t rideClosest[STATS_RIDE_HISTORY]; // 下标 0 为本次骑行，单位米
+};
+
+// 交通统计：每个目标 O(1) 更新计数，定期整块落盘，无需解析日志
+class TrafficStats {
+private:
+    TrafficStatsRecord rec;
+    bool dirty;
+    unsigned long lastSaveTime;
+
+    bool save();
+
+public:
+    TrafficStats();
+
+    // 读取历史记录并开始一次新的骑行
+    void begin();
+
+    void recordApproach(uint8_t distance);
+
+    void recordTarget(uint8_t distance, uint8_t speed, int8_t angle, bool isDanger);
+
+    // 在主循环中调用，idle 为 true（无音频播放）时才按间隔落盘
+    void loop(bool idle);
+
+    // 清空计数，落盘推迟到下一次空闲的 loop
+    void reset();
+
+    void writeJson(Print &out) const;
+};
+
+#endif // TRAFFIC_STATS_H
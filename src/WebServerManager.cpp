@@ -1,35 +1,638 @@
 #include "WebServerManager.h"
 #include "Radar.h"
+#include "RideRecorder.h"
 #include <ESP8266WiFi.h>
 #include <LittleFS.h>
+#include <StreamString.h>
 #include <Updater.h>
 #include <ArduinoJson.h>
+#include <lwip/opt.h>
+
+static const size_t UPLOAD_FS_RESERVE = 16384; // 上传时额外预留的空间（两个 LittleFS 块）
+// 推迟确认后对端最多再发一个 TCP 接收窗口，外加请求解析器暂存的一段（1460 字节）；
+// 空闲不足此值时推迟确认，环形缓冲再多留一块，保证主循环写出整块后总能恢复确认
+static const size_t UPLOAD_HOLD_FREE = TCP_WND + 1460;
+static const size_t UPLOAD_RING_SIZE = ((UPLOAD_HOLD_FREE + UPLOAD_BLOCK_SIZE - 1) / UPLOAD_BLOCK_SIZE + 1) * UPLOAD_BLOCK_SIZE;
 
 WebServerManager::WebServerManager(ConfigManager *configMgr) : server(80), configManager(configMgr) {
     shouldRestart = false;
+    routesReady = false;
     rebootAtMillis = 0;
     radar = nullptr;
+    heapMonitor = nullptr;
+    stallWatchdog = nullptr;
+    for (int i = 0; i < UPLOAD_SLOT_COUNT; i++) {
+        uploadSlots[i].request = nullptr;
+        uploadSlots[i].ring = nullptr;
+        uploadSlots[i].queued = false;
+        uploadSlots[i].abandoned = false;
+    }
+    for (int i = 0; i < DOWNLOAD_SLOT_COUNT; i++) {
+        downloadSlots[i].request = nullptr;
+        downloadSlots[i].exporter = nullptr;
+        downloadSlots[i].abandoned = false;
+    }
+    configBodyOwner = nullptr;
+    configPatchQueued = false;
+    hasDeferred = false;
+    deferred.request = nullptr;
+    assets = nullptr;
+}
+
+
+// 按位计算 CRC32（IEEE 802.3），上传文件只有几十 KB，无需查表
+static uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return ~crc;
+}
+
+static const char *contentTypeFor(const char *path) {
+    const char *ext = strrchr(path, '.');
+    if (ext == nullptr) {
+        return "application/octet-stream";
+    }
+    if (strcmp(ext, ".html") == 0) {
+        return "text/html";
+    }
+    if (strcmp(ext, ".ico") == 0) {
+        return "image/x-icon";
+    }
+    if (strcmp(ext, ".mp3") == 0) {
+        return "audio/mpeg";
+    }
+    return "application/octet-stream";
 }
 
+UploadSlot *WebServerManager::findUploadSlot(AsyncWebServerRequest *request) {
+    for (int i = 0; i < UPLOAD_SLOT_COUNT; i++) {
+        if (uploadSlots[i].request == request && !uploadSlots[i].queued && !uploadSlots[i].abandoned) {
+            return &uploadSlots[i];
+        }
+    }
+    return nullptr;
+}
+
+UploadSlot *WebServerManager::acquireUploadSlot(AsyncWebServerRequest *request) {
+    for (int i = 0; i < UPLOAD_SLOT_COUNT; i++) {
+        UploadSlot &slot = uploadSlots[i];
+        if (slot.request != nullptr) {
+            continue;
+        }
+        snprintf(slot.tmpPath, sizeof(slot.tmpPath), "/upload%d.tmp", i);
+        slot.path = "";
+        slot.received = 0;
+        slot.written = 0;
+        slot.held = 0;
+        slot.acked = 0;
+        slot.expectedSize = 0;
+        slot.contentLength = 0;
+        slot.crc = 0;
+        slot.opened = false;
+        slot.isMp3 = false;
+        slot.queued = false;
+        slot.abandoned = false;
+        slot.scanner.reset();
+        slot.errorCode = 0;
+        slot.error = nullptr;
+        // 配置模式下 MP3 解码器内存已归还，环形缓冲只在上传期间占用堆
+        slot.ring = (uint8_t *) malloc(UPLOAD_RING_SIZE);
+        if (slot.ring == nullptr) {
+            failUpload(&slot, 503, "内存不足");
+        }
+        slot.request = request;
+        return &slot;
+    }
+    return nullptr;
+}
+
+void WebServerManager::releaseUploadSlot(UploadSlot *slot) {
+    if (slot->file) {
+        slot->file.close();
+    }
+    // 未提交的临时文件直接丢弃，原文件保持不变
+    if (slot->opened && LittleFS.exists(slot->tmpPath)) {
+        LittleFS.remove(slot->tmpPath);
+    }
+    slot->opened = false;
+    free(slot->ring);
+    slot->ring = nullptr;
+    slot->path = "";
+    slot->queued = false;
+    slot->abandoned = false;
+    // 最后交还通道，此后 SYS 上下文才会重新占用
+    __sync_synchronize();
+    slot->request = nullptr;
+}
+
+void WebServerManager::failUpload(UploadSlot *slot, int code, const char *message) {
+    if (slot->error == nullptr) {
+        slot->errorCode = code;
+        slot->error = message;
+    }
+}
+
+bool WebServerManager::openUpload(UploadSlot *slot) {
+    // 预先检查剩余空间：替换完成前旧文件仍占用空间
+    FSInfo info;
+    if (!LittleFS.info(info) || info.totalBytes - info.usedBytes < slot->contentLength + UPLOAD_FS_RESERVE) {
+        failUpload(slot, 507, "存储空间不足");
+        return false;
+    }
+    slot->file = LittleFS.open(slot->tmpPath, "w");
+    if (!slot->file) {
+        failUpload(slot, 500, "文件创建失败");
+        return false;
+    }
+    slot->opened = true;
+    return true;
+}
+
+bool WebServerManager::drainUpload(UploadSlot *slot, bool all) {
+    // 环形缓冲为整块大小的整数倍，整块写入不会跨越缓冲末尾
+    while (true) {
+        const size_t pending = slot->received - slot->written;
+        if (pending == 0 || (!all && pending < UPLOAD_BLOCK_SIZE)) {
+            return true;
+        }
+        const size_t n = pending < UPLOAD_BLOCK_SIZE ? pending : UPLOAD_BLOCK_SIZE;
+        if (slot->file.write(slot->ring + slot->written % UPLOAD_RING_SIZE, n) != n) {
+            return false;
+        }
+        slot->written += n;
+        if (!all) {
+            // 每轮每个通道最多写一块，单次写入耗时有界
+            return true;
+        }
+    }
+}
+
+void WebServerManager::commitUpload(UploadSlot *slot) {
+    if (slot->error != nullptr) {
+        return;
+    }
+    if (!slot->opened && !openUpload(slot)) {
+        return;
+    }
+    if (!drainUpload(slot, true)) {
+        failUpload(slot, 500, "文件写入失败");
+        return;
+    }
+    slot->file.close();
+    if (slot->expectedSize > 0 && slot->received != slot->expectedSize) {
+        failUpload(slot, 400, "文件大小与声明不符");
+        return;
+    }
+    // 回读临时文件核对大小与 CRC32，确认数据完整落盘后再替换；数据已全部写出，环形缓冲用作读缓冲
+    File check = LittleFS.open(slot->tmpPath, "r");
+    if (!check) {
+        failUpload(slot, 500, "文件校验失败");
+        return;
+    }
+    uint32_t crc = 0;
+    const size_t size = check.size();
+    size_t n;
+    while ((n = check.read(slot->ring, UPLOAD_BLOCK_SIZE)) > 0) {
+        crc = crc32Update(crc, slot->ring, n);
+    }
+    check.close();
+    if (size != slot->received || crc != slot->crc) {
+        failUpload(slot, 500, "文件校验失败");
+        return;
+    }
+    // 在设备端校验音效并生成帧索引，不合格的音效不替换原文件
+    if (slot->isMp3 && !slot->scanner.finish()) {
+        failUpload(slot, 400, slot->scanner.getError());
+        return;
+    }
+    const String indexPath = Mp3Scanner::indexPathFor(slot->path);
+    if (slot->isMp3) {
+        // 先删除旧索引，若替换后掉电，启动时会按新文件重建
+        LittleFS.remove(indexPath);
+    }
+    if (!LittleFS.rename(slot->tmpPath, slot->path.c_str())) {
+        failUpload(slot, 500, "文件替换失败");
+        return;
+    }
+    if (slot->isMp3 && !slot->scanner.saveIndex(indexPath)) {
+        LittleFS.remove(indexPath);
+    }
+}
+
+void WebServerManager::serviceUploads() {
+    for (int i = 0; i < UPLOAD_SLOT_COUNT; i++) {
+        UploadSlot *slot = &uploadSlots[i];
+        // 已提交的上传由 WEB_CMD_COMMIT_UPLOAD 写完剩余数据并回收
+        if (slot->request == nullptr || slot->queued) {
+            continue;
+        }
+        if (slot->abandoned) {
+            releaseUploadSlot(slot);
+            continue;
+        }
+        if (slot->error == nullptr) {
+            // 文件系统写入会打断 MP3 解码，音频播放期间暂停写出，缓冲将满时对端随接收窗口关闭而等待
+            if (radar != nullptr && radar->isAudioBusy()) {
+                continue;
+            }
+            if ((slot->opened || openUpload(slot)) && !drainUpload(slot, false)) {
+                failUpload(slot, 500, "文件写入失败");
+            }
+        }
+        if (slot->error != nullptr) {
+            // 出错后丢弃缓冲中的数据，让对端发完请求体以便收到错误应答
+            if (slot->file) {
+                slot->file.close();
+            }
+            slot->written = slot->received;
+        }
+        // 缓冲重新有足够空间后补发推迟的确认，ack 不超过实际推迟的字节数
+        const size_t held = slot->held;
+        if (held != slot->acked && UPLOAD_RING_SIZE - (slot->received - slot->written) >= UPLOAD_HOLD_FREE) {
+            slot->request->client()->ack(held - slot->acked);
+            slot->acked = held;
+        }
+    }
+}
 
 void WebServerManager::handleFileUpload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data,size_t len, bool final) {
-    static File uploadFile;
+    UploadSlot *slot;
     if (!index) {
-        String path = "/" + filename;
-        uploadFile = LittleFS.open(path, "w");
-        if (!uploadFile) {
-            request->send(500, "text/plain; charset=utf-8", "文件创建失败");
+        slot = acquireUploadSlot(request);
+        if (slot == nullptr) {
+            // 无空闲通道，由请求回调返回 503
             return;
         }
+        // 客户端中途断开时交由主循环回收通道并丢弃临时文件
+        request->onDisconnect([this, request]() {
+            forgetRequest(request);
+        });
+        slot->path = "/" + filename;
+        slot->isMp3 = slot->path.endsWith(".mp3");
+        slot->contentLength = request->contentLength();
+        if (request->hasParam("size", true)) {
+            slot->expectedSize = strtoul(request->getParam("size", true)->value().c_str(), nullptr, 10);
+        }
+        // 剩余空间检查与创建临时文件由主循环完成（serviceUploads）
+    } else {
+        slot = findUploadSlot(request);
+    }
+    if (slot == nullptr || slot->error != nullptr) {
+        return;
+    }
+    const size_t start = slot->received;
+    if (slot->expectedSize > 0 && start + len > slot->expectedSize) {
+        failUpload(slot, 400, "文件大小与声明不符");
+        return;
+    }
+    if (len > UPLOAD_RING_SIZE - (start - slot->written)) {
+        failUpload(slot, 503, "接收缓冲溢出");
+        return;
+    }
+    slot->crc = crc32Update(slot->crc, data, len);
+    if (slot->isMp3) {
+        slot->scanner.feed(data, len);
+    }
+    // 放入环形缓冲，写入文件由主循环按整块完成
+    const size_t pos = start % UPLOAD_RING_SIZE;
+    const size_t first = len < UPLOAD_RING_SIZE - pos ? len : UPLOAD_RING_SIZE - pos;
+    memcpy(slot->ring + pos, data, first);
+    memcpy(slot->ring, data + first, len - first);
+    __sync_synchronize();
+    slot->received = start + len;
+    if (UPLOAD_RING_SIZE - (slot->received - slot->written) < UPLOAD_HOLD_FREE) {
+        // 暂不确认本段，接收窗口随之收缩，由主循环写出后补发确认
+        request->client()->ackLater();
+        slot->held += len;
     }
-    if (uploadFile) {
-        uploadFile.write(data, len);
+    // 剩余数据的写入、回读校验与替换在主循环中完成（WEB_CMD_COMMIT_UPLOAD）
+    (void) final;
+}
+
+bool WebServerManager::postCommand(AsyncWebServerRequest *request, WebCommandType type, uint8_t arg, uint8_t alert) {
+    WebCommand cmd;
+    cmd.type = type;
+    cmd.arg = arg;
+    cmd.alert = alert;
+    cmd.postedAt = millis();
+    cmd.request = request;
+    if (!commands.push(cmd)) {
+        request->send(503, "text/plain; charset=utf-8", "设备忙，请稍后重试");
+        return false;
+    }
+    request->onDisconnect([this, request]() {
+        forgetRequest(request);
+    });
+    return true;
+}
+
+void WebServerManager::forgetRequest(AsyncWebServerRequest *request) {
+    if (configBodyOwner == request) {
+        configBodyOwner = nullptr;
+    }
+    UploadSlot *slot = findUploadSlot(request);
+    if (slot != nullptr) {
+        slot->abandoned = true;
     }
-    if (final) {
-        if (uploadFile) {
-            uploadFile.close();
+    for (int i = 0; i < DOWNLOAD_SLOT_COUNT; i++) {
+        if (downloadSlots[i].request == request) {
+            downloadSlots[i].abandoned = true;
+        }
+    }
+    // 已入队的命令照常执行，只是不再应答；空闲槽中残留的旧指针一并清除无妨
+    for (uint8_t i = 0; i < WEB_COMMAND_QUEUE_SIZE; i++) {
+        WebCommand &cmd = commands.slotAt(i);
+        if (cmd.request == request) {
+            cmd.request = nullptr;
+        }
+    }
+    if (deferred.request == request) {
+        deferred.request = nullptr;
+    }
+}
+
+void WebServerManager::postDownload(AsyncWebServerRequest *request, const char *path, const char *contentType,
+                                    const char *missing, uint16_t ride, uint32_t fromMs) {
+    for (int i = 0; i < DOWNLOAD_SLOT_COUNT; i++) {
+        DownloadSlot &slot = downloadSlots[i];
+        if (slot.request != nullptr) {
+            continue;
+        }
+        strlcpy(slot.path, path, sizeof(slot.path));
+        slot.ride = ride;
+        slot.fromMs = fromMs;
+        slot.contentType = contentType;
+        slot.missing = missing;
+        slot.len = 0;
+        slot.pos = 0;
+        slot.eof = false;
+        slot.abandoned = false;
+        slot.request = request;
+        if (!postCommand(request, WEB_CMD_OPEN_DOWNLOAD, (uint8_t) i)) {
+            slot.request = nullptr;
+        }
+        return;
+    }
+    request->send(503, "text/plain; charset=utf-8", "下载通道繁忙，请稍后重试");
+}
+
+bool WebServerManager::openDownload(DownloadSlot *slot) {
+    if (slot->path[0] == '\0') {
+        slot->exporter = new RideExport(slot->ride, slot->fromMs);
+        return true;
+    }
+    if (!LittleFS.exists(slot->path)) {
+        return false;
+    }
+    slot->file = LittleFS.open(slot->path, "r");
+    return (bool) slot->file;
+}
+
+void WebServerManager::releaseDownloadSlot(DownloadSlot *slot) {
+    if (slot->file) {
+        slot->file.close();
+    }
+    delete slot->exporter;
+    slot->exporter = nullptr;
+    slot->abandoned = false;
+    __sync_synchronize();
+    slot->request = nullptr;
+}
+
+void WebServerManager::serviceDownloads() {
+    for (int i = 0; i < DOWNLOAD_SLOT_COUNT; i++) {
+        DownloadSlot *slot = &downloadSlots[i];
+        if (slot->request == nullptr) {
+            continue;
+        }
+        if (slot->abandoned) {
+            releaseDownloadSlot(slot);
+            continue;
+        }
+        // 回调尚未发送完上一块，或已读完，或尚未打开（打开由 WEB_CMD_OPEN_DOWNLOAD 完成）
+        if (slot->len != 0 || slot->eof || (!slot->file && slot->exporter == nullptr)) {
+            continue;
+        }
+        size_t n;
+        if (slot->exporter != nullptr) {
+            n = slot->exporter->fill(slot->buf, DOWNLOAD_BUFFER_SIZE);
+        } else {
+            n = slot->file.read(slot->buf, DOWNLOAD_BUFFER_SIZE);
+        }
+        __sync_synchronize();
+        if (n == 0) {
+            slot->eof = true;
+        } else {
+            slot->len = (uint16_t) n;
+        }
+    }
+}
+
+// SYS 上下文：分块应答回调只拷贝主循环填好的数据，尚未填好时稍后重试
+static size_t copyDownload(DownloadSlot *slot, uint8_t *out, size_t maxLen) {
+    const uint16_t len = slot->len;
+    if (len == 0) {
+        return slot->eof ? 0 : RESPONSE_TRY_AGAIN;
+    }
+    size_t n = len - slot->pos;
+    if (n > maxLen) {
+        n = maxLen;
+    }
+    memcpy(out, slot->buf + slot->pos, n);
+    slot->pos += n;
+    if (slot->pos == len) {
+        slot->pos = 0;
+        __sync_synchronize();
+        slot->len = 0;
+    }
+    return n;
+}
+
+void WebServerManager::executeCommand(const WebCommand &cmd) {
+    int code = 200;
+    String message;
+    const char *contentType = "text/plain; charset=utf-8";
+    bool reboot = false;
+    switch (cmd.type) {
+        case WEB_CMD_TEST_ALERT:
+            radar->testFunction((AlertId) cmd.arg);
+            message = "已触发功能";
+            break;
+        case WEB_CMD_CLEAR_LOG:
+            if (!LittleFS.begin()) {
+                code = 500;
+                message = "文件系统不可用";
+            } else if (LittleFS.exists("/radar.log")) {
+                LittleFS.remove("/radar.log");
+                message = "已清空日志";
+            } else {
+                message = "日志不存在";
+            }
+            break;
+        case WEB_CMD_RESET_STATS:
+            radar->resetStats();
+            message = "已清空统计";
+            break;
+        case WEB_CMD_RESET_CLUTTER:
+            radar->resetClutterMap();
+            message = "已重置杂波图";
+            break;
+        case WEB_CMD_APPLY_CONFIG: {
+            reboot = (pendingPatch.changed & (CFG_AUDIO_ENABLED | CFG_AUDIO_I2S | CFG_AUDIO_SYNTH | CFG_TELEMETRY_ENABLED
+                                              | CFG_TELEMETRY_PORT | CFG_TELEMETRY_SSID | CFG_TELEMETRY_PASSWORD)) != 0;
+            const bool changed = pendingPatch.changed != 0;
+            const bool ok = configManager->applyPatch(pendingPatch);
+            configPatchQueued = false;
+            if (!ok) {
+                reboot = false;
+                code = 500;
+                message = "配置保存失败";
+            } else if (reboot) {
+                message = "配置保存成功，设备将重启";
+            } else {
+                message = changed ? "配置保存成功" : "配置未变化";
+            }
+            break;
+        }
+        case WEB_CMD_COMMIT_UPLOAD: {
+            UploadSlot *slot = &uploadSlots[cmd.arg];
+            commitUpload(slot);
+            if (slot->error != nullptr) {
+                code = slot->errorCode;
+                message = String("上传失败：") + slot->error;
+            } else {
+                // 时长取设备端解析出的实际值并写入配置
+                const unsigned long durationMs = slot->isMp3 ? slot->scanner.getInfo().durationMs : 0;
+                if (durationMs > 0 && cmd.alert != ALERT_NONE) {
+                    configManager->setAudioDuration((AlertId) cmd.alert, durationMs);
+                }
+                // 上传的同名文件覆盖内置资源
+                if (assets) {
+                    assets->markUploaded(slot->path.c_str());
+                    assets->refresh();
+                }
+                if (radar) {
+                    radar->reloadAudioIndex();
+                }
+                message = "上传完成";
+            }
+            releaseUploadSlot(slot);
+            break;
+        }
+        case WEB_CMD_BENCH_ASSET: {
+            AssetBench b;
+            assets->benchmark(cmd.arg, b);
+            const AssetEntry &e = assets->get(cmd.arg);
+            contentType = "application/json; charset=utf-8";
+            message = "{\"name\":\"";
+            message += e.name;
+            message += "\",\"size\":";
+            message += e.size;
+            message += ",\"flashOpenUs\":";
+            message += b.flashOpenUs;
+            message += ",\"flashReadUs\":";
+            message += b.flashReadUs;
+            if (b.fsCopied) {
+                message += ",\"fsOpenUs\":";
+                message += b.fsOpenUs;
+                message += ",\"fsReadUs\":";
+                message += b.fsReadUs;
+            }
+            message += '}';
+            break;
+        }
+        case WEB_CMD_LIST_RIDES: {
+            StreamString list;
+            RideRecorder::writeRideListJson(list);
+            contentType = "application/json; charset=utf-8";
+            message = list;
+            break;
+        }
+        case WEB_CMD_OPEN_DOWNLOAD: {
+            DownloadSlot *slot = &downloadSlots[cmd.arg];
+            // 已断开的请求不再打开，通道由 serviceDownloads 回收
+            if (cmd.request == nullptr || slot->abandoned) {
+                return;
+            }
+            if (!openDownload(slot)) {
+                code = 404;
+                message = slot->missing;
+                break;
+            }
+            // 先读出第一块，回调首次调用即有数据可发
+            serviceDownloads();
+            cmd.request->send(cmd.request->beginChunkedResponse(slot->contentType,
+                [slot](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                    (void) index;
+                    return copyDownload(slot, buffer, maxLen);
+                }));
+            return;
+        }
+    }
+    if (reboot) {
+        rebootAtMillis = millis() + 500;
+        shouldRestart = true;
+    }
+    // 执行完成后再读取应答对象，期间断开的请求已被置空
+    AsyncWebServerRequest *request = cmd.request;
+    if (request == nullptr) {
+        return;
+    }
+    AsyncWebServerResponse *resp = request->beginResponse(code, contentType, message);
+    if (reboot) {
+        resp->addHeader("Connection", "close");
+    }
+    request->send(resp);
+}
+
+// 只读命令（列表与下载）不必在音频播放期间推迟
+static bool touchesFilesystem(WebCommandType type) {
+    switch (type) {
+        case WEB_CMD_CLEAR_LOG:
+        case WEB_CMD_APPLY_CONFIG:
+        case WEB_CMD_COMMIT_UPLOAD:
+        case WEB_CMD_BENCH_ASSET:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool WebServerManager::mustDefer(const WebCommand &cmd) const {
+    // 文件系统写入会打断 MP3 解码，音频播放期间推迟执行，超时后不再等待
+    return touchesFilesystem(cmd.type) && radar != nullptr && radar->isAudioBusy()
+           && millis() - cmd.postedAt < WEB_COMMAND_MAX_DEFER_MS;
+}
+
+void WebServerManager::processCommands() {
+    const unsigned long startUs = micros();
+    // 暂存的命令比队列中所有命令都早，先于队列执行
+    if (hasDeferred && !mustDefer(deferred)) {
+        executeCommand(deferred);
+        hasDeferred = false;
+    }
+    WebCommand *cmd;
+    while ((cmd = commands.peek()) != nullptr) {
+        if (hasDeferred && touchesFilesystem(cmd->type)) {
+            // 文件系统命令之间保持提交顺序，等暂存的那条执行后再继续
+            break;
+        }
+        if (mustDefer(*cmd)) {
+            deferred = *cmd;
+            hasDeferred = true;
+            commands.pop();
+            continue;
+        }
+        executeCommand(*cmd);
+        commands.pop();
+        if (micros() - startUs >= WEB_COMMAND_BUDGET_US) {
+            break;
         }
-        request->send(200, "text/plain; charset=utf-8", "文件上传完成");
     }
 }
 
@@ -44,6 +647,11 @@ void initWiFi() {
 
 void WebServerManager::begin() {
     initWiFi();
+    if (routesReady) {
+        server.begin();
+        return;
+    }
+    routesReady = true;
     server.on("/version", HTTP_GET, [](AsyncWebServerRequest *request) {
         String json = String("{") +
                       "\"version\":\"" + String(FIRMWARE_VERSION) + "\"," +
@@ -53,50 +661,164 @@ void WebServerManager::begin() {
     });
 
     server.on("/config", HTTP_GET, [this](AsyncWebServerRequest *request) {
-        String config = configManager->getConfigJson();
-        request->send(200, "application/json; charset=utf-8", config);
+        AsyncResponseStream *resp = request->beginResponseStream("application/json; charset=utf-8");
+        configManager->writeConfigJson(*resp);
+        request->send(resp);
     });
 
     // 日志查看与下载
-    server.on("/logs", HTTP_GET, [](AsyncWebServerRequest *request) {
-        if (LittleFS.exists("/radar.log")) {
-            request->send(LittleFS, "/radar.log", "text/plain; charset=utf-8");
-        } else {
-            request->send(404, "text/plain; charset=utf-8", "日志不存在");
+    server.on("/logs", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        postDownload(request, "/radar.log", "text/plain; charset=utf-8", "日志不存在");
+    });
+    server.on("/logs/download", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        // 不在后端设置 Content-Disposition，以便文件名以“前端 a.download”为准
+        postDownload(request, "/radar.log", "application/octet-stream", "日志不存在");
+    });
+    server.on("/logs/clear", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        postCommand(request, WEB_CMD_CLEAR_LOG);
+    });
+
+    // 交通统计（直方图），直接由内存中的计数生成
+    server.on("/stats", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (!radar) {
+            request->send(500, "text/plain; charset=utf-8", "Radar 未初始化");
+            return;
         }
+        AsyncResponseStream *resp = request->beginResponseStream("application/json; charset=utf-8");
+        radar->getStats().writeJson(*resp);
+        request->send(resp);
     });
-    server.on("/logs/download", HTTP_GET, [](AsyncWebServerRequest *request) {
-        if (LittleFS.exists("/radar.log")) {
-            // 不在后端设置 Content-Disposition，以便文件名以“前端 a.download”为准
-            request->send(LittleFS, "/radar.log", "application/octet-stream");
-        } else {
-            request->send(404, "text/plain; charset=utf-8", "日志不存在");
+    server.on("/heap", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (!heapMonitor) {
+            request->send(500, "text/plain; charset=utf-8", "HeapMonitor 未初始化");
+            return;
         }
+        AsyncResponseStream *resp = request->beginResponseStream("application/json; charset=utf-8");
+        heapMonitor->writeJson(*resp);
+        request->send(resp);
     });
-    server.on("/logs/clear", HTTP_POST, [](AsyncWebServerRequest *request) {
-        if (!LittleFS.begin()) {
-            request->send(500, "text/plain; charset=utf-8", "文件系统不可用");
+    server.on("/diag/clear", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (!stallWatchdog) {
+            request->send(500, "text/plain; charset=utf-8", "StallWatchdog 未初始化");
             return;
         }
-        if (LittleFS.exists("/radar.log")) {
-            LittleFS.remove("/radar.log");
-            request->send(200, "text/plain; charset=utf-8", "已清空日志");
-        } else {
-            request->send(200, "text/plain; charset=utf-8", "日志不存在");
+        stallWatchdog->clear();
+        request->send(200, "text/plain; charset=utf-8", "卡顿记录已清除");
+    });
+    server.on("/diag", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (!stallWatchdog) {
+            request->send(500, "text/plain; charset=utf-8", "StallWatchdog 未初始化");
+            return;
         }
+        AsyncResponseStream *resp = request->beginResponseStream("application/json; charset=utf-8");
+        stallWatchdog->writeJson(*resp);
+        request->send(resp);
+    });
+    server.on("/profile", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (!radar) {
+            request->send(500, "text/plain; charset=utf-8", "Radar 未初始化");
+            return;
+        }
+        AsyncResponseStream *resp = request->beginResponseStream("application/json; charset=utf-8");
+        radar->writeProfileJson(*resp);
+        request->send(resp);
+    });
+    server.on("/sensors", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (!radar) {
+            request->send(500, "text/plain; charset=utf-8", "Radar 未初始化");
+            return;
+        }
+        AsyncResponseStream *resp = request->beginResponseStream("application/json; charset=utf-8");
+        radar->writeSensorJson(*resp);
+        request->send(resp);
+    });
+    // 杂波图快照，reset 需先于 /clutter 注册
+    server.on("/clutter/reset", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (!radar) {
+            request->send(500, "text/plain; charset=utf-8", "Radar 未初始化");
+            return;
+        }
+        postCommand(request, WEB_CMD_RESET_CLUTTER);
+    });
+    server.on("/clutter", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (!radar) {
+            request->send(500, "text/plain; charset=utf-8", "Radar 未初始化");
+            return;
+        }
+        AsyncResponseStream *resp = request->beginResponseStream("application/json; charset=utf-8");
+        radar->getClutterMap().writeJson(*resp);
+        request->send(resp);
+    });
+    // 内置资源镜像：条目列表，以及逐个资源对比闪存与 LittleFS 的打开和读取耗时（bench 需先于 /assets 注册）
+    server.on("/assets/bench", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (!assets) {
+            request->send(500, "text/plain; charset=utf-8", "AssetStore 未初始化");
+            return;
+        }
+        if (!request->hasParam("name")) {
+            request->send(400, "text/plain; charset=utf-8", "缺少 name 参数");
+            return;
+        }
+        const String name = request->getParam("name")->value();
+        for (uint8_t i = 0; i < assets->getCount(); i++) {
+            if (name == assets->get(i).name) {
+                postCommand(request, WEB_CMD_BENCH_ASSET, i);
+                return;
+            }
+        }
+        request->send(404, "text/plain; charset=utf-8", "资源不存在");
+    });
+    server.on("/assets", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (!assets) {
+            request->send(500, "text/plain; charset=utf-8", "AssetStore 未初始化");
+            return;
+        }
+        AsyncResponseStream *resp = request->beginResponseStream("application/json; charset=utf-8");
+        assets->writeJson(*resp);
+        request->send(resp);
+    });
+    server.on("/stats/reset", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (!radar) {
+            request->send(500, "text/plain; charset=utf-8", "Radar 未初始化");
+            return;
+        }
+        postCommand(request, WEB_CMD_RESET_STATS);
+    });
+
+    // 骑行轨迹：列表与按骑行导出（CSV，主循环分块解码），export 需先于 /rides 注册
+    server.on("/rides/export", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (!request->hasParam("ride")) {
+            request->send(400, "text/plain; charset=utf-8", "缺少参数 ride");
+            return;
+        }
+        const uint16_t ride = (uint16_t) strtoul(request->getParam("ride")->value().c_str(), nullptr, 10);
+        uint32_t fromMs = 0;
+        if (request->hasParam("from")) {
+            fromMs = strtoul(request->getParam("from")->value().c_str(), nullptr, 10);
+        }
+        postDownload(request, "", "text/csv; charset=utf-8", "骑行不存在", ride, fromMs);
+    });
+    server.on("/rides", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        postCommand(request, WEB_CMD_LIST_RIDES);
     });
 
     server.on("/testFunction", HTTP_POST, [this](AsyncWebServerRequest *request) {
         if (radar) {
-            String function = "normal";
+            const char *function = "normal";
             if (request->hasParam("function")) {
-                function = request->getParam("function")->value();
+                function = request->getParam("function")->value().c_str();
             }
-            if (function == "reboot") {
+            if (strcmp(function, "reboot") == 0) {
                 rebootAtMillis = millis() + 500;
                 shouldRestart = true;
             } else {
-                radar->testFunction(function);
+                const AlertId alert = alertFromType(function);
+                if (alert == ALERT_NONE) {
+                    request->send(400, "text/plain; charset=utf-8", "未知功能");
+                    return;
+                }
+                postCommand(request, WEB_CMD_TEST_ALERT, alert);
+                return;
             }
             request->send(200, "text/plain; charset=utf-8", "已触发功能");
         } else {
@@ -104,71 +826,68 @@ void WebServerManager::begin() {
         }
     });
 
-    server.on("/config", HTTP_POST, [this](AsyncWebServerRequest *request) {
-                  request->send(400, "text/plain; charset=utf-8", "请使用正确的请求格式");
-              }, nullptr, [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-                  static String body = "";
-                  if (index == 0) {
-                      body = "";
+    // 请求体由 body 回调写入预分配缓冲，接收完成后在请求回调中解析一次并统一应答；支持 PATCH 局部更新
+    server.on("/config", HTTP_POST | HTTP_PATCH, [this](AsyncWebServerRequest *request) {
+                  if (configBodyOwner != request) {
+                      if (configBodyOwner != nullptr || configPatchQueued) {
+                          request->send(409, "text/plain; charset=utf-8", "另一配置请求正在处理");
+                      } else {
+                          request->send(400, "text/plain; charset=utf-8", "请使用正确的请求格式");
+                      }
+                      return;
                   }
-                  for (size_t i = 0; i < len; i++) {
-                      body += (char) data[i];
+                  configBodyOwner = nullptr;
+                  if (configBody.isTooLarge()) {
+                      request->send(413, "text/plain; charset=utf-8", "配置内容过大");
+                      return;
                   }
-                  if (index + len == total) {
-                      bool needReboot = false;
-                      StaticJsonDocument<512> doc;
-                      DeserializationError err = deserializeJson(doc, body);
-                      if (!err) {
-                          const auto &oldCfg = configManager->getConfig();
-                          bool newAudioEnabled = doc["audioEnabled"].isNull()? oldCfg.audioEnabled: (bool) doc["audioEnabled"];
-                          bool newAudioI2S = doc["audioI2S"].isNull() ? oldCfg.audioI2S : (bool) doc["audioI2S"];
-                          needReboot = (newAudioEnabled != oldCfg.audioEnabled) || (newAudioI2S != oldCfg.audioI2S);
+                  // 解析只读写内存，在此完成；保存配置交给主循环
+                  if (!configManager->parsePatch(configBody.data(), configBody.length(), pendingPatch)) {
+                      String msg = pendingPatch.error;
+                      if (pendingPatch.field != nullptr) {
+                          msg += "：";
+                          msg += pendingPatch.field;
                       }
-                      if (configManager->updateConfig(body)) {
-                          if (needReboot) {
-                              AsyncWebServerResponse *resp = request->beginResponse(200, "text/plain; charset=utf-8", "配置保存成功，设备将重启");
-                              resp->addHeader("Connection", "close");
-                              request->send(resp);
-                              rebootAtMillis = millis() + 500;
-                              shouldRestart = true;
-                          } else {
-                              request->send(200, "text/plain; charset=utf-8", "配置保存成功");
-                          }
-                      } else {
-                          request->send(500, "text/plain; charset=utf-8", "配置保存失败");
+                      request->send(400, "text/plain; charset=utf-8", msg);
+                      return;
+                  }
+                  configPatchQueued = postCommand(request, WEB_CMD_APPLY_CONFIG);
+              }, nullptr, [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+                  if (index == 0) {
+                      if (configBodyOwner != nullptr || configPatchQueued) {
+                          return;
                       }
+                      configBodyOwner = request;
+                      configBody.reset(total);
+                      request->onDisconnect([this, request]() {
+                          forgetRequest(request);
+                      });
+                  }
+                  if (configBodyOwner == request) {
+                      configBody.append(data, len, index);
                   }
               });
 
     server.on("/upload", HTTP_POST, [this](AsyncWebServerRequest *request) {
-                  // 在上传完成后的请求回调中读取表单参数：type 与 durationMs，并写入配置
-                  String type = "";
-                  unsigned long durationMs = 0;
-                  if (request->hasParam("type", true)) {
-                      type = request->getParam("type", true)->value();
-                      type.toLowerCase();
+                  UploadSlot *slot = findUploadSlot(request);
+                  if (slot == nullptr) {
+                      request->send(503, "text/plain; charset=utf-8", "上传通道繁忙或未收到文件");
+                      return;
                   }
-                  if (request->hasParam("durationMs", true)) {
-                      String d = request->getParam("durationMs", true)->value();
-                      durationMs = strtoul(d.c_str(), nullptr, 10);
+                  if (slot->error != nullptr) {
+                      request->send(slot->errorCode, "text/plain; charset=utf-8", String("上传失败：") + slot->error);
+                      slot->abandoned = true;
+                      return;
                   }
-                  if (durationMs > 0 && type.length() > 0) {
-                      String field;
-                      if (type == "normal") field = "audioDurationMsNormal";
-                      else if (type == "danger") field = "audioDurationMsDanger";
-                      else if (type == "left") field = "audioDurationMsLeft";
-                      else if (type == "right") field = "audioDurationMsRight";
-                      else if (type == "rear") field = "audioDurationMsRear";
-                      else if (type == "start") field = "audioDurationMsStart";
-                      if (field.length() > 0) {
-                          StaticJsonDocument<128> doc;
-                          doc[field] = durationMs;
-                          String body;
-                          serializeJson(doc, body);
-                          configManager->updateConfig(body);
-                      }
+                  // 在上传完成后的请求回调中读取表单参数 type，校验、替换与写入配置交给主循环
+                  AlertId alert = ALERT_NONE;
+                  if (request->hasParam("type", true)) {
+                      alert = alertFromType(request->getParam("type", true)->value().c_str());
+                  }
+                  slot->queued = postCommand(request, WEB_CMD_COMMIT_UPLOAD, (uint8_t) (slot - uploadSlots), alert);
+                  if (!slot->queued) {
+                      slot->abandoned = true;
                   }
-                  request->send(200, "text/plain; charset=utf-8", "上传完成");
               }, [this](AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len,bool final) {
                   handleFileUpload(request, filename, index, data, len, final);
               });
@@ -224,20 +943,62 @@ void WebServerManager::begin() {
                       }
                   }
               });
-    server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
-    server.onNotFound([](AsyncWebServerRequest *request) {
-        request->send(404, "text/plain; charset=utf-8", "页面未找到");
+    // 网页、图标与音效预览优先取内置资源，不经过文件系统查找
+    for (uint8_t i = 0; assets != nullptr && i < assets->getCount(); i++) {
+        const char *name = assets->get(i).name;
+        server.on(name, HTTP_GET, [this, name](AsyncWebServerRequest *request) {
+            sendAsset(request, name);
+        });
+    }
+    server.on("/", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        sendAsset(request, "/index.html");
+    });
+    // 其余 GET 请求按路径查找 LittleFS 中的文件，经下载通道由主循环读取
+    server.onNotFound([this](AsyncWebServerRequest *request) {
+        if (request->method() != HTTP_GET || request->url().length() >= sizeof(DownloadSlot::path)) {
+            request->send(404, "text/plain; charset=utf-8", "页面未找到");
+            return;
+        }
+        sendAsset(request, request->url().c_str());
     });
     server.begin();
 }
 
+void WebServerManager::end() {
+    server.end();
+}
+
 void WebServerManager::loop() {
+    processCommands();
+    serviceUploads();
+    serviceDownloads();
     if (shouldRestart && millis() >= rebootAtMillis) {
         shouldRestart = false;
         ESP.restart();
     }
 }
 
+void WebServerManager::sendAsset(AsyncWebServerRequest *request, const char *path) {
+    const int8_t index = assets != nullptr ? assets->find(path) : -1;
+    if (index < 0) {
+        postDownload(request, path, contentTypeFor(path), "页面未找到");
+        return;
+    }
+    request->send(request->beginResponse_P(200, contentTypeFor(path), assets->data(index), assets->get(index).size));
+}
+
 void WebServerManager::setRadar(Radar *r) {
     radar = r;
 }
+
+void WebServerManager::setHeapMonitor(HeapMonitor *m) {
+    heapMonitor = m;
+}
+
+void WebServerManager::setStallWatchdog(StallWatchdog *w) {
+    stallWatchdog = w;
+}
+
+void WebServerManager::setAssetStore(AssetStore *a) {
+    assets = a;
+}
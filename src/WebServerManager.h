@@ -2,8 +2,88 @@
 #define WEBSERVER_MANAGER_H
 
 #include <ESPAsyncWebServer.h>
+#include <LittleFS.h>
 #include "ConfigManager.h"
+#include "Mp3Scanner.h"
+#include "HeapMonitor.h"
+#include "StallWatchdog.h"
+#include "AssetStore.h"
+#include "SpscQueue.h"
+#include "BodyBuffer.h"
 class Radar; // 前向声明
+class RideExport;
+
+#define UPLOAD_SLOT_COUNT 2      // 允许同时进行的上传数
+#define UPLOAD_BLOCK_SIZE 512    // 每次写入临时文件的块大小，为 LittleFS 页大小（256）的整数倍
+#define DOWNLOAD_SLOT_COUNT 2    // 允许同时进行的文件下载与轨迹导出数
+#define DOWNLOAD_BUFFER_SIZE 512 // 主循环每次为下载读出的字节数
+#define CONFIG_BODY_MAX 1024     // POST /config 请求体上限
+#define WEB_COMMAND_QUEUE_SIZE 8         // 2 的幂，最多同时排队 7 条命令
+#define WEB_COMMAND_BUDGET_US 5000       // 主循环每轮执行命令的时间预算，至少执行一条
+#define WEB_COMMAND_MAX_DEFER_MS 3000    // 涉及文件系统的命令在音频播放期间最多推迟的时长
+
+// 单个上传请求的状态：SYS 上下文只把数据放入接收环形缓冲，主循环创建临时文件并按块写入，
+// 校验通过后再原子替换目标文件；缓冲将满时推迟 TCP 确认，由主循环写出后再确认
+struct UploadSlot {
+    AsyncWebServerRequest *request; // nullptr 表示空闲，只由主循环回收
+    File file;                      // 临时文件，只在主循环中打开与写入
+    String path;
+    char tmpPath[16];
+    uint8_t *ring;                  // 接收环形缓冲，上传开始时分配，回收时释放
+    volatile size_t received;       // SYS 上下文已放入环形缓冲的字节数
+    size_t written;                 // 主循环已写入临时文件的字节数
+    volatile size_t held;           // SYS 上下文推迟确认的字节数
+    size_t acked;                   // 主循环已补发确认的字节数
+    size_t expectedSize;            // 前端声明的文件大小，0 表示未声明
+    size_t contentLength;           // 请求体长度，主循环创建临时文件前据此检查剩余空间
+    uint32_t crc;                   // 接收数据的 CRC32，落盘后回读比对
+    bool opened;                    // 主循环已创建临时文件
+    bool isMp3;
+    volatile bool queued;           // 已提交给主循环校验替换，断开连接时不再释放
+    volatile bool abandoned;        // 客户端已断开或已应答错误，等待主循环删除临时文件并回收
+    Mp3Scanner scanner;
+    int errorCode;
+    const char *error;
+};
+
+// 单个下载请求的状态：文件与骑行轨迹只在主循环中读取，填入 buf 后由分块应答回调（SYS 上下文）拷贝发送
+struct DownloadSlot {
+    AsyncWebServerRequest *request; // nullptr 表示空闲，只由主循环回收
+    char path[32];                  // 空串表示导出骑行轨迹
+    uint16_t ride;
+    uint32_t fromMs;
+    const char *contentType;
+    const char *missing;            // 文件不存在时的 404 提示
+    File file;
+    RideExport *exporter;
+    uint8_t buf[DOWNLOAD_BUFFER_SIZE];
+    volatile uint16_t len;          // 主循环填入后发布，回调发送完后清零交还主循环
+    uint16_t pos;                   // 回调已发送到的位置
+    volatile bool eof;              // 主循环已读完
+    volatile bool abandoned;        // 客户端已断开，等待主循环关闭文件并回收
+};
+
+// 网页请求转交主循环执行的命令：处理函数运行在 SYS 上下文，只负责校验参数并入队，
+// 文件系统读写、音频与配置修改都在主循环中完成，再由主循环发送应答
+enum WebCommandType : uint8_t {
+    WEB_CMD_TEST_ALERT,
+    WEB_CMD_CLEAR_LOG,
+    WEB_CMD_RESET_STATS,
+    WEB_CMD_RESET_CLUTTER,
+    WEB_CMD_APPLY_CONFIG,       // 补丁在 pendingPatch 中，同一时间只有一条
+    WEB_CMD_COMMIT_UPLOAD,
+    WEB_CMD_BENCH_ASSET,        // 对比内置资源与 LittleFS 的读取耗时
+    WEB_CMD_LIST_RIDES,
+    WEB_CMD_OPEN_DOWNLOAD       // 打开下载通道中的文件或骑行轨迹并开始分块应答
+};
+
+struct WebCommand {
+    WebCommandType type;
+    uint8_t arg;                // 音效编号、上传或下载通道编号、资源下标
+    uint8_t alert;              // 上传对应的音效，ALERT_NONE 表示不更新时长
+    unsigned long postedAt;
+    AsyncWebServerRequest *request; // 应答对象，客户端断开后置空
+};
 
 #ifndef FIRMWARE_VERSION
 #define FIRMWARE_VERSION "1.7"
@@ -17,15 +97,65 @@ private:
     AsyncWebServer server;
     ConfigManager* configManager;
     volatile bool shouldRestart;
+    bool routesReady;           // 路由只注册一次，再次进入配置模式时只需重新监听
     unsigned long rebootAtMillis;
     Radar* radar;
+    HeapMonitor* heapMonitor;
+    StallWatchdog* stallWatchdog;
+    AssetStore* assets;
+    UploadSlot uploadSlots[UPLOAD_SLOT_COUNT];
+    DownloadSlot downloadSlots[DOWNLOAD_SLOT_COUNT];
+    // POST /config 请求体缓冲，预先分配，同一时间只接收一个请求
+    BodyBuffer<CONFIG_BODY_MAX> configBody;
+    AsyncWebServerRequest *configBodyOwner;
+    ConfigPatch pendingPatch;
+    volatile bool configPatchQueued;
+    SpscQueue<WebCommand, WEB_COMMAND_QUEUE_SIZE> commands;
+    // 音频播放期间推迟的文件系统命令移出队列暂存于此，后面的非文件系统命令照常执行
+    WebCommand deferred;
+    bool hasDeferred;
+
+    UploadSlot *findUploadSlot(AsyncWebServerRequest *request);
+    UploadSlot *acquireUploadSlot(AsyncWebServerRequest *request);
+    // 主循环：关闭并删除未提交的临时文件，释放缓冲后交还通道
+    void releaseUploadSlot(UploadSlot *slot);
+    bool openUpload(UploadSlot *slot);
+    // 主循环：把环形缓冲中的整块写入临时文件，all 为 true 时连同末尾不足一块的数据
+    bool drainUpload(UploadSlot *slot, bool all);
+    void commitUpload(UploadSlot *slot);
+    // 只记录错误，临时文件由主循环删除，可在任一上下文调用
+    void failUpload(UploadSlot *slot, int code, const char *message);
+    // 主循环：创建临时文件、写出接收缓冲、补发确认，并回收断开或出错的通道
+    void serviceUploads();
+    // SYS 上下文：占用一个下载通道并提交 WEB_CMD_OPEN_DOWNLOAD，无空闲通道时应答 503
+    void postDownload(AsyncWebServerRequest *request, const char *path, const char *contentType, const char *missing,
+                      uint16_t ride = 0, uint32_t fromMs = 0);
+    bool openDownload(DownloadSlot *slot);
+    void releaseDownloadSlot(DownloadSlot *slot);
+    // 主循环：为已发送完的下载通道读出下一块，并回收断开的通道
+    void serviceDownloads();
+    // SYS 上下文：入队并登记断开回调，队列满时直接应答 503
+    bool postCommand(AsyncWebServerRequest *request, WebCommandType type, uint8_t arg = 0, uint8_t alert = ALERT_NONE);
+    // SYS 上下文：客户端断开时清理该请求占用的配置缓冲与待发送应答，上传与下载通道标记后交主循环回收
+    void forgetRequest(AsyncWebServerRequest *request);
+    // 文件系统命令在音频播放期间需要推迟（最多 WEB_COMMAND_MAX_DEFER_MS）
+    bool mustDefer(const WebCommand &cmd) const;
+    void processCommands();
+    void executeCommand(const WebCommand &cmd);
+    // 内置资源直接从闪存发送，被上传文件覆盖或不在镜像中时经下载通道发送 LittleFS 中的文件
+    void sendAsset(AsyncWebServerRequest *request, const char *path);
     
 public:
     WebServerManager(ConfigManager* configMgr);
     void begin();
+    // 退出配置模式：停止监听端口，WiFi 是否保留由调用方决定
+    void end();
     void loop();
     void handleFileUpload(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final);
     void setRadar(Radar* r);
+    void setHeapMonitor(HeapMonitor* m);
+    void setStallWatchdog(StallWatchdog* w);
+    void setAssetStore(AssetStore* a);
 };
 
 #endif
\ No newline at end of file
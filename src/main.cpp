@@ -1,8 +1,14 @@
 #include <Arduino.h>
 #include <OneButton.h>
 #include <ESP8266WiFi.h>
+#include "FeatureProfile.h"
 #include "Radar.h"
+#if RADAR_FEATURE_WEB
 #include "WebServerManager.h"
+#endif
+#include "HeapMonitor.h"
+#include "StallWatchdog.h"
+#include "AssetStore.h"
 
 #define BTN_PIN 13
 
@@ -10,39 +16,108 @@ OneButton btn(BTN_PIN);
 
 ConfigManager configMgr;
 
+#if RADAR_FEATURE_WEB
 WebServerManager webServer(&configMgr);
+#endif
 
 Radar radar(&configMgr);
 
+#if RADAR_FEATURE_TELEMETRY
+Telemetry telemetry;
+#endif
+
+HeapMonitor heapMonitor;
+
+StallWatchdog stallWatchdog;
+
+AssetStore assets;
+
+#if RADAR_FEATURE_WEB
 bool configMode = false;
 
 static void startConfigMode() {
     configMode = true;
+    // 热点与网页服务需要的堆与 MP3 解码缓冲互斥，配置期间音效改为播放时分配
+    radar.releaseAudioArena();
     // 启动 AP 并启动配置网页服务（在 WebServerManager::begin 内部完成）
     webServer.begin();
+    heapMonitor.mark(HEAP_STAGE_WEB);
     // Serial.println("配置模式已开启：请连接 AP 'Radar'，访问 192.168.4.1");
 }
 
 static void stopConfigMode() {
+    // 无论 WiFi 是否保留都停止网页服务：遥测连接路由器时，配置、上传与 OTA 接口不能留在局域网上
+    webServer.end();
+#if RADAR_FEATURE_TELEMETRY
+    if (telemetry.isActive()) {
+        // 遥测仍需 WiFi：连接路由器时只关闭热点，自建热点时保持不变
+        if (telemetry.isStation()) {
+            WiFi.softAPdisconnect(true);
+        }
+        configMode = false;
+        radar.reserveAudioArena();
+        return;
+    }
+#endif
     // Serial.println("配置模式已关闭，WiFi关闭以节省资源");
     // 关闭 AP / WiFi，释放无线资源
     WiFi.softAPdisconnect(true);
     WiFi.disconnect(true);
     WiFi.mode(WIFI_OFF);
     configMode = false;
+    radar.reserveAudioArena();
+}
+#endif
+
+#ifdef RADAR_CYCLE_REPORT_MS
+// 定期从串口输出每帧周期统计，供没有网页的编译配置比较热路径开销
+static void reportFrameCycles() {
+    static unsigned long lastReport = 0;
+    const unsigned long now = millis();
+    if (now - lastReport < RADAR_CYCLE_REPORT_MS) {
+        return;
+    }
+    lastReport = now;
+    const FrameCycleStats &c = radar.getFrameCycles();
+    Serial.printf("[%s] frames=%u cycles last=%u avg=%u max=%u heap=%u\n", RADAR_PROFILE, (unsigned) c.frames,
+                  (unsigned) c.last, (unsigned) (c.frames > 0 ? c.sum / c.frames : 0), (unsigned) c.max,
+                  (unsigned) ESP.getFreeHeap());
 }
+#endif
 
 void setup() {
     Serial.begin(115200);
-    // 默认关闭 WiFi 以节省资源，只有进入配置模式时才开启
+    heapMonitor.mark(HEAP_STAGE_SETUP);
+    // 尽早读取 RTC 中上次复位前的现场，之后的阶段切换会覆盖它
+    stallWatchdog.begin();
+    // 默认关闭 WiFi 以节省资源，只有进入配置模式或开启遥测时才开启
     WiFi.mode(WIFI_OFF);
     configMgr.loadConfig();
+    // 内置资源索引读入内存，删除旧版本留下的同名文件，并检查 LittleFS 中是否有上传的同名文件
+    assets.begin();
+#if RADAR_FEATURE_TELEMETRY
+    telemetry.begin(configMgr.getConfig());
+    radar.setTelemetry(&telemetry);
+#endif
+    radar.setWatchdog(&stallWatchdog);
+    radar.setAssetStore(&assets);
+#if RADAR_FEATURE_WEB
     webServer.setRadar(&radar);
+    webServer.setHeapMonitor(&heapMonitor);
+    webServer.setStallWatchdog(&stallWatchdog);
+    webServer.setAssetStore(&assets);
+#endif
     delay(500);
     radar.begin();
+    heapMonitor.mark(HEAP_STAGE_RADAR);
     btn.attachLongPressStart([] {
         ESP.restart();
     });
+    // 双击切换骑行档位：只切换内存中预先算好的档位，不解析配置、不写 flash
+    btn.attachDoubleClick([] {
+        radar.indicateProfile(configMgr.nextProfile());
+    });
+#if RADAR_FEATURE_WEB
     btn.attachClick([] {
         if (!configMode) {
             startConfigMode();
@@ -50,11 +125,25 @@ void setup() {
             stopConfigMode();
         }
     });
+#endif
 }
 
 void loop() {
+    stallWatchdog.beginPass();
+#if RADAR_FEATURE_TELEMETRY
+    telemetry.loopTick();
+#endif
     radar.warning();
+#if RADAR_FEATURE_WEB
+    stallWatchdog.enter(PHASE_WEB);
     webServer.loop();
+#endif
+    stallWatchdog.enter(PHASE_BUTTON);
     btn.tick();
+    heapMonitor.sample();
+    stallWatchdog.endPass();
+#ifdef RADAR_CYCLE_REPORT_MS
+    reportFrameCycles();
+#endif
     yield();
 }
@@ -0,0 +1,195 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// 主机单元测试用的 Arduino 替身：只提供被测模块用到的部分，时间由测试代码设置
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define HIGH 1
+#define LOW 0
+
+#define PROGMEM
+#define pgm_read_word(addr) (*(const uint16_t *) (addr))
+
+inline unsigned long hostMillis = 0;
+
+inline unsigned long millis() {
+    return hostMillis;
+}
+
+inline unsigned long micros() {
+    return hostMillis * 1000UL;
+}
+
+inline void yield() {
+}
+
+template<typename T, typename L, typename H>
+inline T constrain(T value, L low, H high) {
+    return value < (T) low ? (T) low : (value > (T) high ? (T) high : value);
+}
+
+// glibc 2.38 以前没有 strlcpy，与 newlib 行为一致：总是以 0 结尾，返回源串长度
+inline size_t hostStrlcpy(char *dst, const char *src, size_t size) {
+    const size_t n = strlen(src);
+    if (size > 0) {
+        const size_t copy = n < size - 1 ? n : size - 1;
+        memcpy(dst, src, copy);
+        dst[copy] = '\0';
+    }
+    return n;
+}
+
+#define strlcpy hostStrlcpy
+
+template<typename T>
+inline T min(T a, T b) {
+    return b < a ? b : a;
+}
+
+template<typename T>
+inline T max(T a, T b) {
+    return a < b ? b : a;
+}
+
+// 只实现被测模块用到的部分：构造、拼接、比较与 c_str
+class String {
+private:
+    std::string s;
+
+public:
+    String() {
+    }
+
+    String(const char *text) : s(text != nullptr ? text : "") {
+    }
+
+    String(const std::string &text) : s(text) {
+    }
+
+    const char *c_str() const {
+        return s.c_str();
+    }
+
+    size_t length() const {
+        return s.size();
+    }
+
+    String operator+(const char *text) const {
+        return String(s + text);
+    }
+
+    String operator+(const String &other) const {
+        return String(s + other.s);
+    }
+
+    String &operator+=(const char *text) {
+        s += text;
+        return *this;
+    }
+
+    bool operator==(const char *text) const {
+        return s == text;
+    }
+
+    bool endsWith(const char *suffix) const {
+        const size_t n = strlen(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+};
+
+inline String operator+(const char *a, const String &b) {
+    return String(a) + b;
+}
+
+class Print {
+public:
+    virtual ~Print() {
+    }
+
+    virtual size_t write(uint8_t b) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            write(buffer[i]);
+        }
+        return size;
+    }
+
+    size_t print(const char *s) {
+        return write((const uint8_t *) s, strlen(s));
+    }
+
+    size_t print(char c) {
+        return write((uint8_t) c);
+    }
+
+    size_t print(int v) {
+        return printf("%d", v);
+    }
+
+    size_t print(unsigned int v) {
+        return printf("%u", v);
+    }
+
+    size_t print(long v) {
+        return printf("%ld", v);
+    }
+
+    size_t print(unsigned long v) {
+        return printf("%lu", v);
+    }
+
+    size_t print(double v) {
+        return printf("%.2f", v);
+    }
+
+    template<typename... Args>
+    size_t printf(const char *fmt, Args... args) {
+        char buf[64];
+        const int n = snprintf(buf, sizeof(buf), fmt, args...);
+        return n > 0 ? write((const uint8_t *) buf, (size_t) n < sizeof(buf) ? n : sizeof(buf) - 1) : 0;
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+
+    virtual int read() = 0;
+
+    virtual int peek() {
+        return -1;
+    }
+
+    size_t readBytesUntil(char terminator, char *buffer, size_t length) {
+        size_t n = 0;
+        while (n < length) {
+            const int c = read();
+            if (c < 0 || c == terminator) {
+                break;
+            }
+            buffer[n++] = (char) c;
+        }
+        return n;
+    }
+};
+
+// 输出收集到字符串，用于检查 writeJson 等输出
+class StringPrint : public Print {
+public:
+    std::string text;
+
+    size_t write(uint8_t b) override {
+        text += (char) b;
+        return 1;
+    }
+
+    using Print::write;
+};
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,278 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// 主机单元测试用的内存文件系统：文件内容保存在 map 中，统计打开与写入次数，
+// 测试据此检查热路径没有访问 flash
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace fs {
+
+enum SeekMode {
+    SeekSet,
+    SeekCur,
+    SeekEnd
+};
+
+struct FSInfo {
+    size_t totalBytes;
+    size_t usedBytes;
+    size_t blockSize;
+    size_t pageSize;
+    size_t maxOpenFiles;
+    size_t maxPathLength;
+};
+
+typedef std::vector<uint8_t> FileData;
+
+class File : public Stream {
+private:
+    std::shared_ptr<FileData> data;
+    std::string path;
+    size_t pos = 0;
+    bool writable = false;
+    size_t *writeOps = nullptr;
+
+public:
+    File() {
+    }
+
+    File(std::shared_ptr<FileData> data, const std::string &path, size_t pos, bool writable, size_t *writeOps)
+        : data(data), path(path), pos(pos), writable(writable), writeOps(writeOps) {
+    }
+
+    size_t write(uint8_t b) override {
+        return write(&b, 1);
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        if (!data || !writable) {
+            return 0;
+        }
+        if (pos + size > data->size()) {
+            data->resize(pos + size);
+        }
+        memcpy(data->data() + pos, buffer, size);
+        pos += size;
+        (*writeOps)++;
+        return size;
+    }
+
+    using Print::write;
+
+    int available() override {
+        return data ? (int) (data->size() - pos) : 0;
+    }
+
+    int read() override {
+        uint8_t b;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+
+    int peek() override {
+        return data && pos < data->size() ? (*data)[pos] : -1;
+    }
+
+    size_t read(uint8_t *buffer, size_t size) {
+        if (!data || pos >= data->size()) {
+            return 0;
+        }
+        const size_t n = min(size, data->size() - pos);
+        memcpy(buffer, data->data() + pos, n);
+        pos += n;
+        return n;
+    }
+
+    bool seek(uint32_t offset, SeekMode mode = SeekSet) {
+        if (!data) {
+            return false;
+        }
+        const size_t base = mode == SeekSet ? 0 : (mode == SeekCur ? pos : data->size());
+        if (base + offset > data->size()) {
+            return false;
+        }
+        pos = base + offset;
+        return true;
+    }
+
+    size_t position() const {
+        return pos;
+    }
+
+    size_t size() const {
+        return data ? data->size() : 0;
+    }
+
+    const char *name() const {
+        const size_t slash = path.rfind('/');
+        return path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+    }
+
+    void flush() {
+    }
+
+    void close() {
+        data.reset();
+    }
+
+    operator bool() const {
+        return (bool) data;
+    }
+};
+
+class Dir {
+private:
+    std::vector<std::pair<std::string, size_t>> entries;
+    size_t index = 0;
+
+public:
+    Dir() {
+    }
+
+    explicit Dir(const std::vector<std::pair<std::string, size_t>> &entries) : entries(entries) {
+    }
+
+    bool next() {
+        if (index >= entries.size()) {
+            return false;
+        }
+        index++;
+        return true;
+    }
+
+    String fileName() const {
+        return index > 0 ? String(entries[index - 1].first) : String();
+    }
+
+    size_t fileSize() const {
+        return index > 0 ? entries[index - 1].second : 0;
+    }
+};
+
+class FS {
+private:
+    std::map<std::string, std::shared_ptr<FileData>> files;
+
+public:
+    size_t openCount = 0;       // 打开文件的次数
+    size_t writeOps = 0;        // 写入调用次数
+    size_t capacity = 1024 * 1024;
+
+    bool begin() {
+        return true;
+    }
+
+    // 清空全部文件与计数，每个测试开始时调用
+    void reset() {
+        files.clear();
+        openCount = 0;
+        writeOps = 0;
+    }
+
+    File open(const char *path, const char *mode) {
+        openCount++;
+        auto it = files.find(path);
+        if (mode[0] == 'r') {
+            if (it == files.end()) {
+                return File();
+            }
+            return File(it->second, path, 0, mode[1] == '+', &writeOps);
+        }
+        if (it == files.end() || mode[0] == 'w') {
+            files[path] = std::make_shared<FileData>();
+            it = files.find(path);
+        }
+        return File(it->second, path, mode[0] == 'a' ? it->second->size() : 0, true, &writeOps);
+    }
+
+    File open(const String &path, const char *mode) {
+        return open(path.c_str(), mode);
+    }
+
+    bool exists(const char *path) {
+        return files.count(path) > 0;
+    }
+
+    bool exists(const String &path) {
+        return exists(path.c_str());
+    }
+
+    bool remove(const char *path) {
+        return files.erase(path) > 0;
+    }
+
+    bool remove(const String &path) {
+        return remove(path.c_str());
+    }
+
+    bool rename(const char *from, const char *to) {
+        auto it = files.find(from);
+        if (it == files.end()) {
+            return false;
+        }
+        files[to] = it->second;
+        files.erase(from);
+        return true;
+    }
+
+    bool rename(const String &from, const String &to) {
+        return rename(from.c_str(), to.c_str());
+    }
+
+    bool mkdir(const char *) {
+        return true;
+    }
+
+    bool info(FSInfo &info) {
+        memset(&info, 0, sizeof(info));
+        info.totalBytes = capacity;
+        for (const auto &f : files) {
+            info.usedBytes += f.second->size();
+        }
+        info.blockSize = 4096;
+        info.pageSize = 256;
+        info.maxOpenFiles = 5;
+        info.maxPathLength = 32;
+        return true;
+    }
+
+    // 与 LittleFS 一致：只列出 path 目录下一层的文件名
+    Dir openDir(const char *path) {
+        std::string prefix = path;
+        if (prefix.empty() || prefix.back() != '/') {
+            prefix += '/';
+        }
+        std::vector<std::pair<std::string, size_t>> entries;
+        for (const auto &f : files) {
+            if (f.first.compare(0, prefix.size(), prefix) == 0
+                && f.first.find('/', prefix.size()) == std::string::npos) {
+                entries.emplace_back(f.first.substr(prefix.size()), f.second->size());
+            }
+        }
+        return Dir(entries);
+    }
+
+    // 测试用：直接取文件内容
+    const FileData *data(const char *path) const {
+        auto it = files.find(path);
+        return it == files.end() ? nullptr : it->second.get();
+    }
+
+    size_t fileCount() const {
+        return files.size();
+    }
+};
+
+} // namespace fs
+
+using fs::Dir;
+using fs::File;
+using fs::FS;
+using fs::FSInfo;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekSet;
+
+#endif // HOST_FS_H
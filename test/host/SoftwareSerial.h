@@ -0,0 +1,70 @@
+#ifndef HOST_SOFTWARE_SERIAL_H
+#define HOST_SOFTWARE_SERIAL_H
+
+// 主机单元测试用的软串口替身：测试代码向接收队列注入字节，模块发出的命令保存在 sent 中
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+
+enum SoftwareSerialConfig {
+    SWSERIAL_8N1
+};
+
+class SoftwareSerial : public Stream {
+public:
+    std::deque<uint8_t> rx;
+    std::vector<uint8_t> sent;
+    unsigned opens = 0;
+    bool isOpen = false;
+    // 最近一次 begin 的实例：被测模块的软串口是私有成员，测试由此取得
+    static inline SoftwareSerial *lastOpened = nullptr;
+
+    void begin(uint32_t baud, SoftwareSerialConfig config, int8_t rxPin, int8_t txPin, bool invert, int bufSize) {
+        (void) baud;
+        (void) config;
+        (void) rxPin;
+        (void) txPin;
+        (void) invert;
+        (void) bufSize;
+        opens++;
+        isOpen = true;
+        lastOpened = this;
+    }
+
+    void end() {
+        isOpen = false;
+        rx.clear();
+    }
+
+    bool overflow() {
+        return false;
+    }
+
+    void inject(const uint8_t *data, size_t len) {
+        if (isOpen) {
+            rx.insert(rx.end(), data, data + len);
+        }
+    }
+
+    int available() override {
+        return (int) rx.size();
+    }
+
+    int read() override {
+        if (rx.empty()) {
+            return -1;
+        }
+        const uint8_t b = rx.front();
+        rx.pop_front();
+        return b;
+    }
+
+    size_t write(uint8_t b) override {
+        sent.push_back(b);
+        return 1;
+    }
+
+    using Print::write;
+};
+
+#endif // HOST_SOFTWARE_SERIAL_H
@@ -0,0 +1,154 @@
+// 杂波图：随车身固定、几乎每帧出现在同一格的回波被学习并抑制，穿过网格的真实来车从不被抑制
+#include <Arduino.h>
+#include <unity.h>
+#include "ClutterMap.h"
+
+#define FRAME_MS 100                    // 雷达约 10Hz 上报
+#define WARMUP_FRAMES 100
+
+static ClutterMap clutter;
+
+static RadarTarget makeTarget(uint8_t distance, uint8_t speed, int8_t angle) {
+    RadarTarget t;
+    t.approaching = true;
+    t.distance = distance;
+    t.speed = speed;
+    t.angle = angle;
+    t.timestamp = 0;
+    t.sensor = 0;
+    return t;
+}
+
+// 与 Radar::processTargets 相同的顺序：先学习本帧全部有效目标，再逐个判断是否抑制
+static void runFrame(const RadarTarget *targets, uint8_t count, bool *suppressed) {
+    clutter.observe(targets, count);
+    for (uint8_t i = 0; i < count; i++) {
+        suppressed[i] = clutter.suppress(targets[i]);
+    }
+}
+
+// 挡泥板反射：2m、正后方，速度读数随车轮转速，每 10 帧丢一帧
+static bool clutterPresent(uint32_t frame) {
+    return frame % 10 != 9;
+}
+
+// 以 speedKmh 从 16m 匀速接近，到 1m 以内后消失；返回是否仍在视场内
+static bool carAt(uint32_t frame, uint32_t startFrame, uint8_t speedKmh, uint8_t &distance) {
+    if (frame < startFrame) {
+        return false;
+    }
+    const float metres = 16.0f - (frame - startFrame) * FRAME_MS * speedKmh / 3600.0f;
+    if (metres < 1.0f) {
+        return false;
+    }
+    distance = (uint8_t) metres;
+    return true;
+}
+
+void setUp() {
+    clutter.reset();
+}
+
+void tearDown() {
+}
+
+void test_persistent_return_suppressed_but_cars_are_not() {
+    uint32_t learnedAt = 0;
+    uint32_t clutterFrames = 0;
+    uint32_t clutterHidden = 0;
+    uint32_t carFrames = 0;
+    for (uint32_t frame = 0; frame < 600; frame++) {
+        RadarTarget targets[4];
+        bool isClutter[4];
+        uint8_t n = 0;
+        if (clutterPresent(frame)) {
+            isClutter[n] = true;
+            targets[n++] = makeTarget(2, 12 + frame % 3, 0);
+        }
+        uint8_t d;
+        // 右后方 20km/h 来车，逐帧经过挡泥板所在的距离格
+        if (carAt(frame, WARMUP_FRAMES, 20, d)) {
+            isClutter[n] = false;
+            targets[n++] = makeTarget(d, 20, 6);
+        }
+        // 6km/h 缓慢接近的车，每个距离格停留约 6 帧
+        if (carAt(frame, WARMUP_FRAMES + 200, 6, d)) {
+            isClutter[n] = false;
+            targets[n++] = makeTarget(d, 6, -10);
+        }
+        bool suppressed[4];
+        runFrame(targets, n, suppressed);
+        for (uint8_t i = 0; i < n; i++) {
+            if (isClutter[i]) {
+                clutterFrames++;
+                if (suppressed[i]) {
+                    clutterHidden++;
+                    if (learnedAt == 0) {
+                        learnedAt = frame;
+                    }
+                }
+            } else {
+                carFrames++;
+                TEST_ASSERT_FALSE(suppressed[i]);
+            }
+        }
+    }
+    TEST_ASSERT_TRUE(learnedAt > 0);
+    TEST_ASSERT_TRUE(learnedAt < WARMUP_FRAMES);
+    TEST_ASSERT_TRUE(carFrames > 100);
+    // 学习完成后挡泥板的每一帧都被抑制
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(clutterFrames - learnedAt, clutterHidden);
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "挡泥板回波第 %lu 帧（%lu ms）起被抑制，共抑制 %lu/%lu 帧；来车 %lu 帧未被抑制",
+             (unsigned long) learnedAt, (unsigned long) learnedAt * FRAME_MS, (unsigned long) clutterHidden,
+             (unsigned long) clutterFrames, (unsigned long) carFrames);
+    TEST_MESSAGE(msg);
+}
+
+void test_intermittent_return_not_learned() {
+    // 不到一半的帧出现在同一格的回波（如偶尔经过的路牌）不判为杂波
+    for (uint32_t frame = 0; frame < 1000; frame++) {
+        const RadarTarget t = makeTarget(8, 10, -20);
+        bool suppressed = false;
+        runFrame(&t, frame % 5 < 2 ? 1 : 0, &suppressed);
+        TEST_ASSERT_FALSE(suppressed);
+    }
+}
+
+void test_duplicate_returns_count_once_per_frame() {
+    // 同一帧同一格出现多次只计一次，每 4 帧出现一次的回波不会因重复上报而被学习
+    const RadarTarget burst[4] = {makeTarget(5, 10, 8), makeTarget(5, 11, 9), makeTarget(5, 12, 10),
+                                  makeTarget(5, 13, 11)};
+    for (uint32_t frame = 0; frame < 1000; frame++) {
+        bool suppressed[4];
+        runFrame(burst, frame % 4 == 0 ? 4 : 0, suppressed);
+        if (frame % 4 == 0) {
+            TEST_ASSERT_FALSE(suppressed[0]);
+        }
+    }
+}
+
+void test_clutter_released_after_it_disappears() {
+    const RadarTarget t = makeTarget(3, 15, 20);
+    bool suppressed = false;
+    for (uint32_t frame = 0; frame < 100; frame++) {
+        runFrame(&t, 1, &suppressed);
+    }
+    TEST_ASSERT_TRUE(suppressed);
+    // 反射物移走后几个衰减周期内解除
+    for (uint32_t frame = 0; frame < 64; frame++) {
+        runFrame(nullptr, 0, nullptr);
+    }
+    runFrame(&t, 1, &suppressed);
+    TEST_ASSERT_FALSE(suppressed);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_persistent_return_suppressed_but_cars_are_not);
+    RUN_TEST(test_intermittent_return_not_learned);
+    RUN_TEST(test_duplicate_returns_count_once_per_frame);
+    RUN_TEST(test_clutter_released_after_it_disappears);
+    return UNITY_END();
+}
@@ -0,0 +1,180 @@
+// POST /config 请求体接收的堆占用对比：预分配的 BodyBuffer 与原先逐字节追加的 String
+#include <Arduino.h>
+#include <unity.h>
+#include <new>
+#include "BodyBuffer.h"
+
+#define CONFIG_BODY_MAX 1024
+
+// 统计全局 new/delete：次数、当前与峰值字节数
+static size_t allocCount = 0;
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+
+void *operator new(size_t size) {
+    size_t *p = (size_t *) malloc(size + sizeof(size_t) * 2);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    p[0] = size;
+    allocCount++;
+    liveBytes += size;
+    if (liveBytes > peakBytes) {
+        peakBytes = liveBytes;
+    }
+    return p + 2;
+}
+
+void operator delete(void *ptr) noexcept {
+    if (ptr != nullptr) {
+        size_t *p = (size_t *) ptr - 2;
+        liveBytes -= p[0];
+        free(p);
+    }
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void *ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+static void resetHeapCounters() {
+    allocCount = 0;
+    peakBytes = liveBytes;
+}
+
+// 原处理函数的写法：static String 逐字节 +=。按 ESP8266 core 3.x WString 的增长方式模拟：
+// 11 字节以内用对象内缓冲，超出后容量按 16 字节取整，每次扩容都重新分配并复制
+class LegacyString {
+private:
+    char sso[12];
+    char *heap = nullptr;
+    size_t len = 0;
+    size_t capacity = 11;
+
+public:
+    ~LegacyString() {
+        delete[] heap;
+    }
+
+    void append(char c) {
+        if (len + 1 > capacity) {
+            const size_t newSize = (len + 1 + 16) & ~(size_t) 0xf;
+            char *next = new char[newSize];
+            memcpy(next, heap != nullptr ? heap : sso, len);
+            delete[] heap;
+            heap = next;
+            capacity = newSize - 1;
+        }
+        (heap != nullptr ? heap : sso)[len++] = c;
+    }
+
+    size_t length() const {
+        return len;
+    }
+};
+
+// 网页“保存配置”提交的典型请求体
+static const char SAMPLE_BODY[] =
+    "{\"detectionDistance\":45,\"detectionSpeed\":10,\"dangerDistance\":15,\"dangerSpeed\":25,"
+    "\"lightBlink\":true,\"blinkDuration\":2,\"normalBlinkInterval\":800,\"dangerBlinkInterval\":120,"
+    "\"warningGain\":2.5,\"audioEnabled\":true,\"audioI2S\":true,\"audioSynth\":false,\"startAudio\":true,"
+    "\"logEnabled\":false,\"trackEnabled\":true,\"clutterFilter\":true,\"telemetryEnabled\":false,"
+    "\"telemetryPort\":4210,\"telemetrySsid\":\"\",\"linkWindowMs\":2000,\"lightAngle\":true,"
+    "\"centerAngle\":5,\"profileName\":\"default\",\"telemetryPassword\":\"0123456789abcdef\"}";
+
+static BodyBuffer<CONFIG_BODY_MAX> body;
+
+// 按 chunk 字节一段模拟 body 回调
+static void feedBody(const char *text, size_t total, size_t chunk) {
+    body.reset(total);
+    for (size_t index = 0; index < total; index += chunk) {
+        const size_t len = total - index < chunk ? total - index : chunk;
+        body.append((const uint8_t *) text + index, len, index);
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_body_buffer_does_not_allocate() {
+    const size_t total = strlen(SAMPLE_BODY);
+    const size_t chunks[] = {1, 64, 536, total};
+    for (size_t chunk : chunks) {
+        resetHeapCounters();
+        feedBody(SAMPLE_BODY, total, chunk);
+        TEST_ASSERT_EQUAL_UINT32(0, allocCount);
+        TEST_ASSERT_FALSE(body.isTooLarge());
+        TEST_ASSERT_EQUAL_UINT32(total, body.length());
+        TEST_ASSERT_EQUAL_MEMORY(SAMPLE_BODY, body.data(), total);
+    }
+}
+
+void test_body_buffer_rejects_oversized_body() {
+    static char big[CONFIG_BODY_MAX + 1];
+    memset(big, ' ', sizeof(big));
+    feedBody(big, CONFIG_BODY_MAX, 100);
+    TEST_ASSERT_FALSE(body.isTooLarge());
+    TEST_ASSERT_EQUAL_UINT32(CONFIG_BODY_MAX, body.length());
+
+    // 声明长度超限时直接标记；未声明长度（分块传输）时在数据超出容量时标记
+    body.reset(CONFIG_BODY_MAX + 1);
+    TEST_ASSERT_TRUE(body.isTooLarge());
+    body.reset(0);
+    TEST_ASSERT_TRUE(body.append((const uint8_t *) big, CONFIG_BODY_MAX, 0));
+    TEST_ASSERT_FALSE(body.append((const uint8_t *) big, 1, CONFIG_BODY_MAX));
+    TEST_ASSERT_TRUE(body.isTooLarge());
+    TEST_ASSERT_FALSE(body.append((const uint8_t *) big, 1, 0));
+}
+
+void test_heap_usage_against_string_append() {
+    const size_t total = strlen(SAMPLE_BODY);
+    resetHeapCounters();
+    const size_t baseLive = liveBytes;
+    size_t legacyAllocs;
+    size_t legacyPeak;
+    {
+        LegacyString legacy;
+        for (size_t i = 0; i < total; i++) {
+            legacy.append(SAMPLE_BODY[i]);
+        }
+        TEST_ASSERT_EQUAL_UINT32(total, legacy.length());
+        legacyAllocs = allocCount;
+        legacyPeak = peakBytes - baseLive;
+    }
+
+    resetHeapCounters();
+    feedBody(SAMPLE_BODY, total, 536);
+    const size_t bufferAllocs = allocCount;
+    const size_t bufferPeak = peakBytes - liveBytes;
+
+    char msg[256];
+    snprintf(msg, sizeof(msg), "%u 字节请求体：String 逐字节追加 %u 次分配、峰值 %u 字节；BodyBuffer %u 次、%u 字节（常驻 %u 字节）",
+             (unsigned) total, (unsigned) legacyAllocs, (unsigned) legacyPeak, (unsigned) bufferAllocs,
+             (unsigned) bufferPeak, (unsigned) sizeof(body));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_EQUAL_UINT32(0, bufferAllocs);
+    TEST_ASSERT_GREATER_THAN_UINT32(total / 16 - 1, legacyAllocs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_body_buffer_does_not_allocate);
+    RUN_TEST(test_body_buffer_rejects_oversized_body);
+    RUN_TEST(test_heap_usage_against_string_append);
+    return UNITY_END();
+}
@@ -0,0 +1,305 @@
+// 24 小时堆浸泡模拟：按骑行时的分配时序（雷达帧、预警播放、日志/轨迹/统计落盘、遥测发包）
+// 在一个仿 umm_malloc 的首次适配堆上运行，检查碎片率、最大连续块与开机状态相比保持不变。
+// 各对象大小为 ESP8266 Arduino 核心与所用库的近似值，只用于检查分配时序，不代表设备实测
+#include <Arduino.h>
+#include <unity.h>
+#include <math.h>
+#include <map>
+#include <vector>
+#include "HeapMonitor.h"
+#include "RideRecorder.h"
+#include "TelemetryPacket.h"
+
+#define SOAK_HOURS 24
+#define FRAME_MS 100
+#define HEAP_BLOCK 8                    // umm_malloc 以 8 字节为块，每块另有 4 字节头
+#define HEAP_HEADER 4
+#define HEAP_FRAGMENTATION_BUDGET 10    // 运行中碎片率上限（%）
+
+// AudioGeneratorMP3::preAllocSize() 的近似值
+#define MP3_ARENA_SIZE 29192
+
+// 近似大小：LittleFS 打开一个文件时的实现对象、lfs_file_t 与文件缓存；lwIP 发送 UDP 时的 pbuf 与协议头
+static const uint32_t FILE_ALLOCS[] = {48, 84, 256};
+static const uint32_t PBUF_OVERHEAD = 16 + 42;
+// 未预留解码缓冲时 AudioGeneratorMP3::begin 分配的输入缓冲与 libmad 结构体
+static const uint32_t MP3_ALLOCS[] = {1536, 80, 9280, 4608, 13600};
+
+class SimHeap {
+private:
+    uint32_t total;
+    std::map<uint32_t, uint32_t> used;   // 偏移 -> 占用字节（含块头与对齐）
+
+public:
+    explicit SimHeap(uint32_t total) : total(total) {
+    }
+
+    // 首次适配，返回偏移，失败返回 -1
+    int32_t alloc(uint32_t size) {
+        const uint32_t need = (size + HEAP_HEADER + HEAP_BLOCK - 1) / HEAP_BLOCK * HEAP_BLOCK;
+        uint32_t pos = 0;
+        for (const auto &u : used) {
+            if (u.first - pos >= need) {
+                break;
+            }
+            pos = u.first + u.second;
+        }
+        if (pos + need > total) {
+            return -1;
+        }
+        used[pos] = need;
+        return (int32_t) pos;
+    }
+
+    void release(int32_t offset) {
+        if (offset >= 0) {
+            used.erase((uint32_t) offset);
+        }
+    }
+
+    template<typename F>
+    void forEachGap(F f) const {
+        uint32_t pos = 0;
+        for (const auto &u : used) {
+            if (u.first > pos) {
+                f(u.first - pos);
+            }
+            pos = u.first + u.second;
+        }
+        if (total > pos) {
+            f(total - pos);
+        }
+    }
+
+    uint32_t freeBytes() const {
+        uint32_t sum = 0;
+        forEachGap([&](uint32_t gap) { sum += gap; });
+        return sum;
+    }
+
+    uint32_t maxBlock() const {
+        uint32_t best = 0;
+        forEachGap([&](uint32_t gap) { best = gap > best ? gap : best; });
+        return best;
+    }
+
+    // 与 ESP.getHeapFragmentation() 相同：100 - sqrt(Σ空闲块²) * 100 / 空闲总量
+    uint8_t fragmentation() const {
+        double squares = 0;
+        double sum = 0;
+        forEachGap([&](uint32_t gap) {
+            squares += (double) gap * gap;
+            sum += gap;
+        });
+        return sum > 0 ? (uint8_t) (100 - (uint32_t) (sqrt(squares) * 100 / sum)) : 0;
+    }
+
+    size_t liveCount() const {
+        return used.size();
+    }
+};
+
+struct Allocation {
+    std::vector<int32_t> offsets;
+    bool failed = false;
+    bool live = false;
+};
+
+template<size_t N>
+static void acquire(SimHeap &heap, Allocation &a, const uint32_t (&sizes)[N]) {
+    a.offsets.clear();
+    a.failed = false;
+    for (uint32_t size : sizes) {
+        const int32_t off = heap.alloc(size);
+        a.failed = a.failed || off < 0;
+        a.offsets.push_back(off);
+    }
+    a.live = true;
+}
+
+static void release(SimHeap &heap, Allocation &a) {
+    for (int32_t off : a.offsets) {
+        heap.release(off);
+    }
+    a.offsets.clear();
+    a.live = false;
+}
+
+// 打开、写入并关闭一个文件
+static void fileWrite(SimHeap &heap) {
+    Allocation f;
+    acquire(heap, f, FILE_ALLOCS);
+    release(heap, f);
+}
+
+struct SoakResult {
+    bool arena;
+    uint32_t bootFree;
+    uint32_t bootMaxBlock;
+    uint32_t minFree;
+    uint32_t minMaxBlock;
+    uint8_t maxFragmentation;
+    uint32_t alerts;
+    uint32_t decoderFailures;
+    uint32_t endFree;
+    uint32_t endMaxBlock;
+    size_t endLive;
+    size_t bootLive;
+};
+
+// heapBytes 为 Radar::begin 时可用的堆；telemetry 开启时每帧发送一包；
+// reserve 为 false 时模拟不预留解码缓冲、每次预警 begin/stop 时分配释放
+static SoakResult runSoak(uint32_t heapBytes, bool telemetry, bool logging, bool reserve) {
+    SimHeap heap(heapBytes);
+    SoakResult r;
+    memset(&r, 0, sizeof(r));
+
+    // 开机常驻：LittleFS 挂载缓冲、音频输出与 MP3 解码器对象；与 Radar::reserveAudioArena 相同，放得下就预留解码缓冲
+    heap.alloc(3 * 256 + 160);
+    heap.alloc(96);
+    heap.alloc(128);
+    r.arena = reserve && heap.alloc(MP3_ARENA_SIZE) >= 0;
+    r.bootFree = heap.freeBytes();
+    r.bootMaxBlock = heap.maxBlock();
+    r.bootLive = heap.liveCount();
+    r.minFree = r.bootFree;
+    r.minMaxBlock = r.bootMaxBlock;
+
+    uint32_t seed = 12345;
+    auto random = [&seed](uint32_t n) {
+        seed = seed * 1103515245UL + 12345UL;
+        return (seed >> 16) % n;
+    };
+
+    Allocation pbuf;
+    Allocation clip;
+    Allocation decoder;
+    bool playing = false;
+    unsigned long playEnd = 0;
+    uint32_t logLines = 0;
+    unsigned long lastLogFlush = 0;
+    unsigned long lastRideFlush = 0;
+    unsigned long lastStatsSave = 0;
+    unsigned long lastSample = 0;
+    const unsigned long endMs = SOAK_HOURS * 3600UL * 1000UL;
+    for (unsigned long now = FRAME_MS; now <= endMs; now += FRAME_MS) {
+        // 遥测：上一包发送完成后由 lwIP 释放，与本帧的其他分配交错
+        if (telemetry) {
+            release(heap, pbuf);
+            const uint32_t size[] = {
+                (uint32_t) (PBUF_OVERHEAD + sizeof(TelemetryHeader) + random(4) * sizeof(TelemetryTarget))};
+            acquire(heap, pbuf, size);
+        }
+        // 预警：平均约 15 秒一次，播放 1.1~1.7 秒（内置音效的实际时长范围）；一半为上传到文件系统的音效
+        if (playing && now >= playEnd) {
+            release(heap, clip);
+            release(heap, decoder);
+            playing = false;
+            logLines++;
+        }
+        if (!playing && random(150) == 0) {
+            r.alerts++;
+            if (random(2) == 0) {
+                acquire(heap, clip, FILE_ALLOCS);
+            }
+            if (!r.arena) {
+                acquire(heap, decoder, MP3_ALLOCS);
+                if (decoder.failed) {
+                    r.decoderFailures++;
+                }
+            }
+            playing = !decoder.failed;
+            if (!playing) {
+                release(heap, clip);
+                release(heap, decoder);
+            }
+            playEnd = now + 1100 + random(600);
+            logLines += 2;
+        }
+        // 日志：有新行且间隔到达即落盘，播放中也会发生
+        if (logging && logLines > 0 && now - lastLogFlush >= 500) {
+            fileWrite(heap);
+            logLines = 0;
+            lastLogFlush = now;
+        }
+        // 轨迹约 4 字节/帧，缓冲过半或 10 秒落盘；统计 2 分钟落盘；两者只在没有音频播放时进行
+        if (!playing && now - lastRideFlush >= (RIDE_BUFFER_SIZE / 2) / 4 * FRAME_MS) {
+            fileWrite(heap);
+            lastRideFlush = now;
+        }
+        if (!playing && now - lastStatsSave >= 120000) {
+            fileWrite(heap);
+            lastStatsSave = now;
+        }
+        if (now - lastSample >= HEAP_SAMPLE_INTERVAL_MS) {
+            lastSample = now;
+            r.minFree = min(r.minFree, heap.freeBytes());
+            r.minMaxBlock = min(r.minMaxBlock, heap.maxBlock());
+            r.maxFragmentation = max(r.maxFragmentation, heap.fragmentation());
+        }
+    }
+    release(heap, pbuf);
+    release(heap, clip);
+    release(heap, decoder);
+    r.endFree = heap.freeBytes();
+    r.endMaxBlock = heap.maxBlock();
+    r.endLive = heap.liveCount();
+    return r;
+}
+
+static void report(const char *name, const SoakResult &r) {
+    char msg[256];
+    snprintf(msg, sizeof(msg),
+             "%s：解码缓冲%s，%lu 次预警，开机空闲 %lu / 最大块 %lu，运行中最低空闲 %lu / 最小最大块 %lu，最高碎片率 %u%%，"
+             "解码分配失败 %lu 次",
+             name, r.arena ? "预留" : "按需分配", (unsigned long) r.alerts, (unsigned long) r.bootFree,
+             (unsigned long) r.bootMaxBlock, (unsigned long) r.minFree, (unsigned long) r.minMaxBlock,
+             (unsigned) r.maxFragmentation, (unsigned long) r.decoderFailures);
+    TEST_MESSAGE(msg);
+}
+
+static void assertFlat(const SoakResult &r) {
+    // 24 小时后回到开机状态：没有泄漏，也没有被长期占住的小块把堆切碎
+    TEST_ASSERT_EQUAL_UINT32(r.bootLive, r.endLive);
+    TEST_ASSERT_EQUAL_UINT32(r.bootFree, r.endFree);
+    TEST_ASSERT_EQUAL_UINT32(r.bootMaxBlock, r.endMaxBlock);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(HEAP_FRAGMENTATION_BUDGET, r.maxFragmentation);
+    TEST_ASSERT_EQUAL_UINT32(0, r.decoderFailures);
+    TEST_ASSERT_TRUE(r.alerts > SOAK_HOURS * 3600 / 30);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_soak_wifi_off() {
+    const SoakResult r = runSoak(48 * 1024, false, true, true);
+    report("WiFi 关闭", r);
+    TEST_ASSERT_TRUE(r.arena);
+    assertFlat(r);
+}
+
+void test_soak_with_telemetry() {
+    // 遥测先于雷达开启 WiFi，开机可用堆更少，解码缓冲仍应预留
+    const SoakResult r = runSoak(40 * 1024, true, true, true);
+    report("遥测开启", r);
+    TEST_ASSERT_TRUE(r.arena);
+    assertFlat(r);
+}
+
+void test_report_per_alert_decoder_buffers() {
+    // 对照：不预留时遥测发包缓冲落在两次预警的解码缓冲之间，把堆切碎，只报告不断言
+    const SoakResult r = runSoak(40 * 1024, true, true, false);
+    report("对照：每次预警分配", r);
+    TEST_ASSERT_FALSE(r.arena);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_soak_wifi_off);
+    RUN_TEST(test_soak_with_telemetry);
+    RUN_TEST(test_report_per_alert_decoder_buffers);
+    return UNITY_END();
+}
@@ -0,0 +1,288 @@
+// 雷达链路健康监测：按主循环节奏向软串口注入静默、噪声与恢复的字节流，
+// 检查状态切换、恢复动作与退避间隔，并报告判定故障与恢复所用的时间
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include "RadarSensor.h"
+#include "RadarLinkHealth.h"
+
+#define TICK_MS 10                      // 主循环节拍
+#define FRAME_PERIOD_MS 100             // 模块上报间隔
+#define WINDOW_MS 2000                  // 与默认 linkWindowMs 一致
+#define MODULE_BOOT_MS 1000             // 收到重启命令后模块重新上报所需时间
+
+static const uint8_t CMD_RESTART[] = {0xFD, 0xFC, 0xFB, 0xFA, 0x02, 0x00, 0xA3, 0x00, 0x04, 0x03, 0x02, 0x01};
+
+// 单目标数据帧；badFooter 为 true 时帧尾错误
+static size_t buildFrame(uint8_t *out, bool badFooter) {
+    static const uint8_t header[] = {0xF4, 0xF3, 0xF2, 0xF1};
+    static const uint8_t footer[] = {0xF8, 0xF7, 0xF6, 0xF5};
+    static const uint8_t broken[] = {0x00, 0x00, 0x00, 0x00};
+    size_t n = 0;
+    memcpy(out, header, 4);
+    n += 4;
+    out[n++] = 7;
+    out[n++] = 0;
+    out[n++] = 1;
+    out[n++] = 0;
+    out[n++] = 0x80;
+    out[n++] = 30;
+    out[n++] = 0x01;
+    out[n++] = 25;
+    out[n++] = 0x40;
+    memcpy(out + n, badFooter ? broken : footer, 4);
+    return n + 4;
+}
+
+// 模块模型：按上报间隔把帧写入软串口接收队列，收到重启命令后停发约 1 秒再恢复
+struct Module {
+    SoftwareSerial *port = nullptr;
+    bool hung = false;                  // 卡死，不再上报
+    bool deaf = false;                  // 卡死且重启命令无效
+    bool noisy = false;                 // 帧间夹杂乱码，每隔一帧帧尾错误
+    unsigned long nextFrame = 0;
+    unsigned long bootUntil = 0;
+    size_t sentSeen = 0;
+    uint32_t frameNo = 0;
+
+    bool receivedRestart() {
+        const auto from = port->sent.begin() + sentSeen;
+        const bool found = std::search(from, port->sent.end(), CMD_RESTART, CMD_RESTART + sizeof(CMD_RESTART))
+                           != port->sent.end();
+        sentSeen = port->sent.size();
+        return found;
+    }
+
+    void tick(unsigned long now) {
+        if (receivedRestart() && !deaf) {
+            hung = false;
+            bootUntil = now + MODULE_BOOT_MS;
+        }
+        if (hung || now < bootUntil || now < nextFrame) {
+            return;
+        }
+        nextFrame = now + FRAME_PERIOD_MS;
+        uint8_t frame[32];
+        if (noisy) {
+            static const uint8_t garbage[] = {0x55, 0xAA, 0x13};
+            port->inject(garbage, sizeof(garbage));
+        }
+        port->inject(frame, buildFrame(frame, noisy && (frameNo & 1)));
+        frameNo++;
+    }
+};
+
+// 与 Radar::checkLinks 相同的调用方式：解析、更新健康状态、执行恢复动作
+struct Rig {
+    RadarSensor sensor;
+    RadarLinkHealth health;
+    Module module;
+    bool allowRestart = true;
+    unsigned long now = 0;
+
+    void begin() {
+        hostMillis = 0;
+        now = 0;
+        sensor = RadarSensor();
+        sensor.attach(0, 14, 12, 0);
+        sensor.begin();
+        module = Module();
+        module.port = SoftwareSerial::lastOpened;
+        health.begin(0);
+    }
+
+    LinkAction step() {
+        now += TICK_MS;
+        hostMillis = now;
+        module.tick(now);
+        RadarTarget targets[RADAR_MAX_TARGETS];
+        uint8_t count;
+        sensor.poll(targets, count, now);
+        const LinkAction action = health.update(sensor.getCounters(), now, WINDOW_MS,
+                                                allowRestart && sensor.canRestart());
+        if (action == LINK_ACTION_REOPEN) {
+            sensor.reopen();
+        } else if (action == LINK_ACTION_RESTART) {
+            sensor.restartModule();
+        }
+        return action;
+    }
+
+    // 运行 ms 毫秒，期间不应有恢复动作
+    void runClean(unsigned long ms) {
+        const unsigned long end = now + ms;
+        while (now < end) {
+            TEST_ASSERT_EQUAL(LINK_ACTION_NONE, step());
+            TEST_ASSERT_EQUAL(LINK_OK, health.getState());
+        }
+    }
+};
+
+static Rig rig;
+
+void setUp() {
+    rig.allowRestart = true;
+    rig.begin();
+}
+
+void tearDown() {
+}
+
+void test_steady_stream_stays_ok() {
+    rig.runClean(30000);
+    TEST_ASSERT_EQUAL_UINT32(0, rig.health.getStats().faults);
+    TEST_ASSERT_EQUAL_UINT32(0, rig.sensor.getCounters().badFrames);
+    TEST_ASSERT_EQUAL_UINT32(1, rig.module.port->opens);
+}
+
+void test_silence_detected_and_recovered_by_restart() {
+    rig.runClean(10000);
+    const unsigned long lastFrame = rig.sensor.getCounters().lastFrameMs;
+    rig.module.hung = true;
+
+    // 一个窗口内无帧判为静默，并立即重开串口
+    LinkAction action = LINK_ACTION_NONE;
+    while (rig.health.getState() == LINK_OK) {
+        action = rig.step();
+    }
+    const unsigned long detectedAt = rig.now;
+    TEST_ASSERT_EQUAL(LINK_SILENT, rig.health.getState());
+    TEST_ASSERT_EQUAL(LINK_ACTION_REOPEN, action);
+    TEST_ASSERT_EQUAL_UINT32(2, rig.module.port->opens);
+    TEST_ASSERT_EQUAL_UINT32(detectedAt - lastFrame, rig.health.getStats().lastDetectMs);
+    TEST_ASSERT_UINT32_WITHIN(TICK_MS, WINDOW_MS, rig.health.getStats().lastDetectMs);
+
+    // 重开无效，一个窗口后发送重启命令，模块约 1 秒后恢复上报
+    unsigned long restartAt = 0;
+    while (rig.health.getState() != LINK_OK) {
+        action = rig.step();
+        if (action == LINK_ACTION_RESTART) {
+            restartAt = rig.now;
+        }
+        TEST_ASSERT_TRUE(rig.now - detectedAt < 10 * WINDOW_MS);
+    }
+    TEST_ASSERT_EQUAL_UINT32(detectedAt + WINDOW_MS, restartAt);
+    TEST_ASSERT_TRUE(std::search(rig.module.port->sent.begin(), rig.module.port->sent.end(), CMD_RESTART,
+                                 CMD_RESTART + sizeof(CMD_RESTART)) != rig.module.port->sent.end());
+    const RadarLinkStats &stats = rig.health.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.faults);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.reopens);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.restarts);
+    TEST_ASSERT_EQUAL_UINT32(rig.now - detectedAt, stats.lastRecoverMs);
+    TEST_ASSERT_UINT32_WITHIN(TICK_MS, WINDOW_MS + MODULE_BOOT_MS, stats.lastRecoverMs);
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "静默：末帧后 %lu ms 判定故障，判定后 %lu ms 恢复（重开 1 次、重启 1 次，窗口 %u ms）",
+             (unsigned long) stats.lastDetectMs, (unsigned long) stats.lastRecoverMs, (unsigned) WINDOW_MS);
+    TEST_MESSAGE(msg);
+    rig.runClean(10000);
+}
+
+// 记录持续静默期间的恢复动作，返回动作个数
+static uint8_t collectActions(unsigned long ms, unsigned long *times, LinkAction *actions, uint8_t max) {
+    uint8_t n = 0;
+    const unsigned long end = rig.now + ms;
+    while (rig.now < end) {
+        const LinkAction action = rig.step();
+        if (action != LINK_ACTION_NONE && n < max) {
+            times[n] = rig.now;
+            actions[n] = action;
+            n++;
+        }
+    }
+    return n;
+}
+
+void test_recovery_actions_back_off() {
+    rig.runClean(5000);
+    rig.module.hung = true;
+    rig.module.deaf = true;
+    unsigned long times[16];
+    LinkAction actions[16];
+    const uint8_t n = collectActions(120000, times, actions, 16);
+    // 间隔依次为 1、2、4、8、16 个窗口，之后保持 16 个窗口；重开与重启交替
+    static const uint8_t windows[] = {1, 2, 4, 8, 16, 16};
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(sizeof(windows) + 1, n);
+    for (uint8_t i = 0; i < sizeof(windows); i++) {
+        TEST_ASSERT_EQUAL_UINT32((uint32_t) windows[i] * WINDOW_MS, times[i + 1] - times[i]);
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL(i % 2 == 0 ? LINK_ACTION_REOPEN : LINK_ACTION_RESTART, actions[i]);
+    }
+    TEST_ASSERT_EQUAL(LINK_SILENT, rig.health.getState());
+    TEST_ASSERT_EQUAL_UINT32(1, rig.health.getStats().faults);
+
+    // 模块恢复后状态回到正常，退避重新计起
+    rig.module.deaf = false;
+    rig.module.hung = false;
+    while (rig.health.getState() != LINK_OK) {
+        rig.step();
+    }
+    rig.runClean(5000);
+}
+
+void test_without_tx_only_reopens() {
+    rig.allowRestart = false;
+    rig.runClean(5000);
+    rig.module.hung = true;
+    unsigned long times[8];
+    LinkAction actions[8];
+    const uint8_t n = collectActions(40000, times, actions, 8);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(4, n);
+    for (uint8_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL(LINK_ACTION_REOPEN, actions[i]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, rig.health.getStats().restarts);
+    TEST_ASSERT_TRUE(rig.module.port->sent.empty());
+}
+
+void test_noise_degrades_then_recovers() {
+    rig.runClean(10000);
+    const unsigned long noiseAt = rig.now;
+    rig.module.noisy = true;
+    LinkAction action = LINK_ACTION_NONE;
+    while (rig.health.getState() == LINK_OK) {
+        action = rig.step();
+        TEST_ASSERT_TRUE(rig.now - noiseAt <= 2 * WINDOW_MS);
+    }
+    const unsigned long detectedAt = rig.now;
+    // 仍有完整帧，判为劣化而不是静默，并立即重开串口
+    TEST_ASSERT_EQUAL(LINK_DEGRADED, rig.health.getState());
+    TEST_ASSERT_EQUAL(LINK_ACTION_REOPEN, action);
+
+    // 噪声持续期间保持劣化，不会误判为静默
+    const unsigned long noiseEnd = noiseAt + 10000;
+    while (rig.now < noiseEnd) {
+        rig.step();
+        TEST_ASSERT_EQUAL(LINK_DEGRADED, rig.health.getState());
+    }
+    TEST_ASSERT_TRUE(rig.sensor.getCounters().badFrames > 0);
+    TEST_ASSERT_TRUE(rig.sensor.getCounters().resyncs > 0);
+
+    // 噪声消失后最迟第二个完整窗口结束时恢复
+    rig.module.noisy = false;
+    while (rig.health.getState() != LINK_OK) {
+        rig.step();
+        TEST_ASSERT_TRUE(rig.now - noiseEnd <= 2 * WINDOW_MS);
+    }
+    const RadarLinkStats &stats = rig.health.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.faults);
+    TEST_ASSERT_EQUAL_UINT32(rig.now - detectedAt, stats.lastRecoverMs);
+
+    char msg[192];
+    snprintf(msg, sizeof(msg), "噪声：开始后 %lu ms 判定劣化，噪声消失后 %lu ms 恢复（故障共 %lu ms，重开 %lu 次、重启 %lu 次）",
+             detectedAt - noiseAt, rig.now - noiseEnd, (unsigned long) stats.lastRecoverMs,
+             (unsigned long) stats.reopens, (unsigned long) stats.restarts);
+    TEST_MESSAGE(msg);
+    rig.runClean(10000);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_stream_stays_ok);
+    RUN_TEST(test_silence_detected_and_recovered_by_restart);
+    RUN_TEST(test_recovery_actions_back_off);
+    RUN_TEST(test_without_tx_only_reopens);
+    RUN_TEST(test_noise_degrades_then_recovers);
+    return UNITY_END();
+}
@@ -0,0 +1,226 @@
+// MP3 帧头流式解析：ID3v2 标签（含尾部标志）、ID3v1 TAG 结尾、流中垃圾字节后重新同步、
+// 帧索引满后减半，以及任意分块边界下结果一致；并扫描 assets/ 中的内置音效
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include <vector>
+#include "Mp3Scanner.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// MPEG1 Layer III、44.1kHz、无填充：帧长 = 144 * kbps * 1000 / 44100
+static const uint8_t BITRATE_INDEX_128 = 9;
+static const uint16_t FRAME_LEN_128 = 417;
+static const uint8_t BITRATE_INDEX_256 = 13;
+
+static void appendFrame(Bytes &out, uint8_t bitrateIndex, uint16_t frameLen) {
+    out.push_back(0xFF);
+    out.push_back(0xFB);
+    out.push_back((uint8_t) (bitrateIndex << 4));
+    out.push_back(0x64);
+    out.insert(out.end(), frameLen - 4, 0x00);
+}
+
+static void appendFrames(Bytes &out, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        appendFrame(out, BITRATE_INDEX_128, FRAME_LEN_128);
+    }
+}
+
+// ID3v2 头：长度为 syncsafe 整数，flags 0x10 表示标签后另有 10 字节尾部
+static void appendId3v2(Bytes &out, uint32_t size, bool footer) {
+    const uint8_t header[10] = {'I', 'D', '3', 4, 0, (uint8_t) (footer ? 0x10 : 0),
+                                (uint8_t) ((size >> 21) & 0x7F), (uint8_t) ((size >> 14) & 0x7F),
+                                (uint8_t) ((size >> 7) & 0x7F), (uint8_t) (size & 0x7F)};
+    out.insert(out.end(), header, header + sizeof(header));
+    // 标签内容里混入同步字，应整体跳过
+    for (uint32_t i = 0; i < size; i++) {
+        out.push_back(i % 7 == 0 ? 0xFF : 0xFB);
+    }
+    if (footer) {
+        const uint8_t tail[10] = {'3', 'D', 'I', 4, 0, 0x10, header[6], header[7], header[8], header[9]};
+        out.insert(out.end(), tail, tail + sizeof(tail));
+    }
+}
+
+static void appendId3v1(Bytes &out) {
+    out.push_back('T');
+    out.push_back('A');
+    out.push_back('G');
+    // 标题等字段里的同步字不应再被当作帧
+    for (uint8_t i = 0; i < 125; i++) {
+        out.push_back(i % 4 == 0 ? 0xFF : 0xFB);
+    }
+}
+
+// 分别整块喂入与按 chunk 字节分块喂入，结果必须一致
+static Mp3IndexHeader scan(const Bytes &data, size_t chunk, bool &ok) {
+    Mp3Scanner scanner;
+    for (size_t i = 0; i < data.size(); i += chunk) {
+        scanner.feed(data.data() + i, min(chunk, data.size() - i));
+    }
+    ok = scanner.finish();
+    return scanner.getInfo();
+}
+
+static Mp3IndexHeader scanAllChunkings(const Bytes &data) {
+    bool ok;
+    const Mp3IndexHeader whole = scan(data, data.size(), ok);
+    TEST_ASSERT_TRUE(ok);
+    const size_t chunks[] = {1, 3, 10, 255};
+    for (size_t chunk : chunks) {
+        const Mp3IndexHeader split = scan(data, chunk, ok);
+        TEST_ASSERT_TRUE(ok);
+        TEST_ASSERT_EQUAL_MEMORY(&whole, &split, sizeof(whole));
+    }
+    return whole;
+}
+
+void setUp() {
+    LittleFS.reset();
+}
+
+void tearDown() {
+}
+
+void test_plain_frames() {
+    Bytes clip;
+    appendFrames(clip, 20);
+    const Mp3IndexHeader info = scanAllChunkings(clip);
+    TEST_ASSERT_EQUAL_UINT32(0, info.dataOffset);
+    TEST_ASSERT_EQUAL_UINT32(clip.size(), info.dataEnd);
+    TEST_ASSERT_EQUAL_UINT32(20, info.frameCount);
+    TEST_ASSERT_EQUAL_UINT32(44100, info.sampleRate);
+    TEST_ASSERT_EQUAL_UINT32(128, info.bitrateKbps);
+    TEST_ASSERT_EQUAL_UINT32(20 * 1152 * 1000 / 44100, info.durationMs);
+}
+
+void test_id3v2_with_and_without_footer() {
+    for (int footer = 0; footer < 2; footer++) {
+        Bytes clip;
+        appendId3v2(clip, 300, footer != 0);
+        appendFrames(clip, 10);
+        const Mp3IndexHeader info = scanAllChunkings(clip);
+        TEST_ASSERT_EQUAL_UINT32(10 + 300 + (footer ? 10 : 0), info.dataOffset);
+        TEST_ASSERT_EQUAL_UINT32(10, info.frameCount);
+        TEST_ASSERT_EQUAL_UINT32(clip.size(), info.dataEnd);
+    }
+}
+
+void test_id3v1_tail_ends_clip() {
+    Bytes clip;
+    appendFrames(clip, 12);
+    const uint32_t audioEnd = clip.size();
+    appendId3v1(clip);
+    const Mp3IndexHeader info = scanAllChunkings(clip);
+    TEST_ASSERT_EQUAL_UINT32(12, info.frameCount);
+    TEST_ASSERT_EQUAL_UINT32(audioEnd, info.dataEnd);
+}
+
+void test_resync_after_garbage() {
+    Bytes clip;
+    appendFrames(clip, 5);
+    // 帧间夹杂无效字节：含不完整的同步字、保留码率与 MPEG 版本不一致的帧头
+    const uint8_t junk[] = {0x00, 0xFF, 0x12, 0xFF, 0xFB, 0xF0, 0x64, 0xFF, 0xF3, 0x90, 0x64, 0x55, 0xFF};
+    clip.insert(clip.end(), junk, junk + sizeof(junk));
+    appendFrames(clip, 7);
+    const Mp3IndexHeader info = scanAllChunkings(clip);
+    TEST_ASSERT_EQUAL_UINT32(12, info.frameCount);
+    TEST_ASSERT_EQUAL_UINT32(0, info.dataOffset);
+    TEST_ASSERT_EQUAL_UINT32(clip.size(), info.dataEnd);
+}
+
+void test_index_halves_when_full() {
+    Bytes clip;
+    const uint32_t frames = 150;
+    appendFrames(clip, frames);
+    Mp3Scanner scanner;
+    scanner.feed(clip.data(), clip.size());
+    TEST_ASSERT_TRUE(scanner.finish());
+    const Mp3IndexHeader &info = scanner.getInfo();
+    // 150 帧：32 条满后步长 1→2→4→8
+    TEST_ASSERT_EQUAL_UINT32(8, info.indexStep);
+    TEST_ASSERT_EQUAL_UINT32((frames + info.indexStep - 1) / info.indexStep, info.indexCount);
+    TEST_ASSERT_TRUE(info.indexCount <= MP3_INDEX_MAX);
+
+    // 落盘的索引：第 i 条是第 i * indexStep 帧的偏移
+    TEST_ASSERT_TRUE(scanner.saveIndex("/clip.mp3.idx"));
+    const fs::FileData *data = LittleFS.data("/clip.mp3.idx");
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(Mp3IndexHeader) + info.indexCount * sizeof(uint32_t), data->size());
+    const uint32_t *offsets = (const uint32_t *) (data->data() + sizeof(Mp3IndexHeader));
+    for (uint16_t i = 0; i < info.indexCount; i++) {
+        TEST_ASSERT_EQUAL_UINT32((uint32_t) i * info.indexStep * FRAME_LEN_128, offsets[i]);
+    }
+    Mp3IndexHeader loaded;
+    TEST_ASSERT_TRUE(Mp3Scanner::loadIndex("/clip.mp3.idx", loaded));
+    TEST_ASSERT_EQUAL_MEMORY(&info, &loaded, sizeof(loaded));
+}
+
+void test_rejects_unplayable_clips() {
+    bool ok;
+    Bytes fast;
+    for (int i = 0; i < 10; i++) {
+        appendFrame(fast, BITRATE_INDEX_256, 835);
+    }
+    scan(fast, fast.size(), ok);
+    TEST_ASSERT_FALSE(ok);
+
+    Bytes longClip;
+    appendFrames(longClip, 200);
+    scan(longClip, longClip.size(), ok);
+    TEST_ASSERT_FALSE(ok);
+
+    Bytes noise(4000, 0x5A);
+    scan(noise, noise.size(), ok);
+    TEST_ASSERT_FALSE(ok);
+}
+
+// 由本文件路径推出工程根目录，读取 assets/ 中的音效
+static bool readAsset(const char *name, Bytes &out) {
+    std::string path = __FILE__;
+    path = path.substr(0, path.rfind("test/test_mp3_scanner")) + "assets/" + name;
+    FILE *f = fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        return false;
+    }
+    uint8_t chunk[256];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        out.insert(out.end(), chunk, chunk + n);
+    }
+    fclose(f);
+    return true;
+}
+
+void test_bundled_clips() {
+    const char *names[] = {"start.mp3", "normal.mp3", "danger.mp3", "left.mp3", "right.mp3", "rear.mp3"};
+    for (const char *name : names) {
+        Bytes clip;
+        if (!readAsset(name, clip)) {
+            TEST_MESSAGE("找不到 assets/ 中的音效，跳过");
+            return;
+        }
+        const Mp3IndexHeader info = scanAllChunkings(clip);
+        TEST_ASSERT_TRUE(info.durationMs > 0);
+        TEST_ASSERT_TRUE(info.dataEnd <= clip.size());
+        char msg[160];
+        // 首帧前的字节数即不用索引时解码器开始出声前要多读的数据
+        snprintf(msg, sizeof(msg), "%s：%lu 字节，首帧偏移 %lu，%lu 帧，%lu Hz，%u kbps，%lu ms", name,
+                 (unsigned long) clip.size(), (unsigned long) info.dataOffset, (unsigned long) info.frameCount,
+                 (unsigned long) info.sampleRate, (unsigned) info.bitrateKbps, (unsigned long) info.durationMs);
+        TEST_MESSAGE(msg);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_plain_frames);
+    RUN_TEST(test_id3v2_with_and_without_footer);
+    RUN_TEST(test_id3v1_tail_ends_clip);
+    RUN_TEST(test_resync_after_garbage);
+    RUN_TEST(test_index_halves_when_full);
+    RUN_TEST(test_rejects_unplayable_clips);
+    RUN_TEST(test_bundled_clips);
+    return UNITY_END();
+}
@@ -0,0 +1,171 @@
+// 骑行档位：/profiles.bin 的生成、读回与切换
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include "RideProfiles.h"
+
+static RideProfile makeBase() {
+    RideProfile base;
+    memset(&base, 0, sizeof(base));
+    strlcpy(base.name, "自定义", sizeof(base.name));
+    base.detectionDistance = 45;
+    base.detectionSpeed = 10;
+    base.dangerDistance = 15;
+    base.dangerSpeed = 25;
+    base.normalBlinkInterval = 800;
+    base.dangerBlinkInterval = 120;
+    base.blinkDuration = 2;
+    base.centerAngle = 5;
+    base.flags = PROFILE_LIGHT_BLINK | PROFILE_LIGHT_ANGLE;
+    base.gainTenths = 25;
+    return base;
+}
+
+// 与 ConfigManager::loadProfiles 相同：读不到档位文件时由默认档位生成并立即落盘
+static void loadOrSeed(RideProfiles &profiles, const RideProfile &base) {
+    if (!profiles.load()) {
+        profiles.seed(base);
+        profiles.save();
+    }
+}
+
+void setUp() {
+    LittleFS.reset();
+}
+
+void tearDown() {
+}
+
+void test_missing_file_seeds_and_saves() {
+    RideProfiles profiles;
+    TEST_ASSERT_FALSE(profiles.load());
+    loadOrSeed(profiles, makeBase());
+
+    TEST_ASSERT_EQUAL_UINT8(3, profiles.getCount());
+    TEST_ASSERT_EQUAL_UINT8(0, profiles.getActive());
+    TEST_ASSERT_EQUAL_STRING("默认", profiles.get(0).name);
+    TEST_ASSERT_EQUAL_STRING("城市", profiles.get(1).name);
+    TEST_ASSERT_EQUAL_STRING("高速", profiles.get(2).name);
+    TEST_ASSERT_EQUAL_UINT8(45, profiles.get(0).detectionDistance);
+    TEST_ASSERT_EQUAL_UINT8(25, profiles.get(1).detectionDistance);
+    TEST_ASSERT_EQUAL_UINT8(70, profiles.get(2).detectionDistance);
+
+    const fs::FileData *data = LittleFS.data(RIDE_PROFILE_PATH);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(RideProfileFile), data->size());
+}
+
+void test_round_trip_preserves_every_field() {
+    RideProfiles written;
+    written.seed(makeBase());
+    RideProfile edited = written.get(1);
+    edited.detectionDistance = 33;
+    edited.dangerBlinkInterval = 90;
+    edited.flags = PROFILE_LIGHT_BLINK;
+    written.update(1, edited);
+    written.setBootProfile(2);
+    TEST_ASSERT_TRUE(written.save());
+
+    RideProfiles read;
+    TEST_ASSERT_TRUE(read.load());
+    TEST_ASSERT_EQUAL_UINT8(written.getCount(), read.getCount());
+    TEST_ASSERT_EQUAL_UINT8(2, read.getBootProfile());
+    // 开机直接进入保存的档位
+    TEST_ASSERT_EQUAL_UINT8(2, read.getActive());
+    for (uint8_t i = 0; i < read.getCount(); i++) {
+        TEST_ASSERT_EQUAL_MEMORY(&written.get(i), &read.get(i), sizeof(RideProfile));
+    }
+    TEST_ASSERT_TRUE(read.select(1));
+    TEST_ASSERT_EQUAL_UINT8(33, read.current().detectionDistance);
+    TEST_ASSERT_EQUAL_UINT32(90, read.current().blinkIntervalMs[1]);
+    TEST_ASSERT_EQUAL_UINT32(2000, read.current().blinkDurationMs);
+    // 关闭分方向后左右同亮
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_DIR_LEFT | PROFILE_DIR_RIGHT, RideProfiles::direction(read.current(), -30));
+}
+
+void test_seeded_file_is_loaded_not_reseeded() {
+    RideProfiles first;
+    loadOrSeed(first, makeBase());
+    RideProfile edited = first.get(0);
+    edited.detectionSpeed = 7;
+    first.update(0, edited);
+    first.save();
+
+    // 第二次启动时默认值已改变，也应以档位文件为准
+    RideProfile changed = makeBase();
+    changed.detectionSpeed = 99;
+    RideProfiles second;
+    loadOrSeed(second, changed);
+    TEST_ASSERT_EQUAL_UINT8(7, second.get(0).detectionSpeed);
+}
+
+void test_corrupt_file_rejected() {
+    RideProfiles profiles;
+    profiles.seed(makeBase());
+    profiles.save();
+
+    // 魔数不符
+    RideProfileFile bad;
+    File f = LittleFS.open(RIDE_PROFILE_PATH, "r");
+    f.read((uint8_t *) &bad, sizeof(bad));
+    f.close();
+    bad.magic ^= 1;
+    f = LittleFS.open(RIDE_PROFILE_PATH, "w");
+    f.write((const uint8_t *) &bad, sizeof(bad));
+    f.close();
+    RideProfiles reader;
+    TEST_ASSERT_FALSE(reader.load());
+
+    // 开机档位越界
+    bad.magic = RIDE_PROFILE_MAGIC;
+    bad.bootProfile = bad.count;
+    f = LittleFS.open(RIDE_PROFILE_PATH, "w");
+    f.write((const uint8_t *) &bad, sizeof(bad));
+    f.close();
+    TEST_ASSERT_FALSE(reader.load());
+
+    // 截断
+    f = LittleFS.open(RIDE_PROFILE_PATH, "w");
+    f.write((const uint8_t *) &bad, sizeof(bad) - 1);
+    f.close();
+    TEST_ASSERT_FALSE(reader.load());
+}
+
+void test_next_cycles_without_touching_flash() {
+    RideProfiles profiles;
+    loadOrSeed(profiles, makeBase());
+    const size_t opens = LittleFS.openCount;
+    // ConfigManager::nextProfile 按键切换档位时调用
+    TEST_ASSERT_EQUAL_UINT8(1, profiles.next());
+    TEST_ASSERT_EQUAL_UINT8(20, profiles.current().dangerSpeed);
+    TEST_ASSERT_EQUAL_UINT8(2, profiles.next());
+    TEST_ASSERT_EQUAL_UINT8(40, profiles.current().dangerSpeed);
+    TEST_ASSERT_EQUAL_UINT8(0, profiles.next());
+    TEST_ASSERT_EQUAL_UINT8(25, profiles.current().dangerSpeed);
+    TEST_ASSERT_EQUAL_UINT32(opens, LittleFS.openCount);
+    TEST_ASSERT_FALSE(profiles.select(3));
+    TEST_ASSERT_EQUAL_UINT8(0, profiles.getActive());
+}
+
+void test_direction_table_matches_center_angle() {
+    RideProfiles profiles;
+    profiles.seed(makeBase());
+    const RideProfileState &state = profiles.current();
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_DIR_LEFT, RideProfiles::direction(state, -128));
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_DIR_LEFT, RideProfiles::direction(state, -5));
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_DIR_LEFT | PROFILE_DIR_RIGHT, RideProfiles::direction(state, -4));
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_DIR_LEFT | PROFILE_DIR_RIGHT, RideProfiles::direction(state, 4));
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_DIR_RIGHT, RideProfiles::direction(state, 5));
+    TEST_ASSERT_EQUAL_UINT8(PROFILE_DIR_RIGHT, RideProfiles::direction(state, 127));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_missing_file_seeds_and_saves);
+    RUN_TEST(test_round_trip_preserves_every_field);
+    RUN_TEST(test_seeded_file_is_loaded_not_reseeded);
+    RUN_TEST(test_corrupt_file_rejected);
+    RUN_TEST(test_next_cycles_without_touching_flash);
+    RUN_TEST(test_direction_table_matches_center_angle);
+    return UNITY_END();
+}
@@ -0,0 +1,240 @@
+// 骑行轨迹：编码后经 RideExport 解码逐帧一致；recordFrame 不访问文件系统；
+// 索引只指向已有数据的段；存档超限时删除本次骑行最早的段。并报告编解码耗时与每条记录字节数
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <unity.h>
+#include <chrono>
+#include <vector>
+#include "RideRecorder.h"
+
+#define FRAME_MS 100
+
+struct Frame {
+    uint32_t t;
+    uint8_t distance;
+    uint8_t speed;
+    int8_t angle;
+};
+
+// 来车从 40m 逐帧接近，速度与角度抖动，车与车之间隔 3 秒无目标
+static Frame makeFrame(uint32_t i, uint32_t &t) {
+    const uint32_t car = i / 60;
+    const uint32_t k = i % 60;
+    if (k == 0 && i > 0) {
+        t += 3000;
+    }
+    t += FRAME_MS;
+    Frame f;
+    f.t = t;
+    f.distance = (uint8_t) (40 - k * 38 / 60);
+    f.speed = (uint8_t) (15 + car % 20 + (k % 3));
+    f.angle = (int8_t) ((int) (car % 7) * 4 - 12 + (int) (k % 5) - 2);
+    return f;
+}
+
+static std::vector<Frame> record(RideRecorder &recorder, uint32_t count, bool idle) {
+    std::vector<Frame> frames;
+    uint32_t t = hostMillis;
+    for (uint32_t i = 0; i < count; i++) {
+        const Frame f = makeFrame(i, t);
+        hostMillis = f.t;
+        recorder.recordFrame(f.distance, f.speed, f.angle);
+        recorder.loop(idle);
+        frames.push_back(f);
+    }
+    return frames;
+}
+
+// 定时落盘间隔过后缓冲一定写出
+static void drain(RideRecorder &recorder) {
+    hostMillis += 20000;
+    recorder.loop(true);
+}
+
+static std::string exportCsv(uint16_t ride, uint32_t fromMs) {
+    RideExport exporter(ride, fromMs);
+    std::string csv;
+    uint8_t chunk[100];
+    size_t n;
+    while ((n = exporter.fill(chunk, sizeof(chunk))) > 0) {
+        csv.append((const char *) chunk, n);
+    }
+    return csv;
+}
+
+static std::vector<RideSegmentInfo> readIndex() {
+    std::vector<RideSegmentInfo> entries;
+    const fs::FileData *data = LittleFS.data(RIDE_INDEX_PATH);
+    if (data != nullptr) {
+        entries.resize(data->size() / sizeof(RideSegmentInfo));
+        memcpy(entries.data(), data->data(), entries.size() * sizeof(RideSegmentInfo));
+    }
+    return entries;
+}
+
+static void assertIndexPointsAtData() {
+    char path[32];
+    for (const RideSegmentInfo &e : readIndex()) {
+        RideRecorder::segmentPath(path, sizeof(path), e.ride, e.segment);
+        const fs::FileData *seg = LittleFS.data(path);
+        TEST_ASSERT_NOT_NULL(seg);
+        TEST_ASSERT_TRUE(seg->size() > 0);
+    }
+}
+
+static void assertCsvMatches(const std::string &csv, const std::vector<Frame> &frames, size_t first) {
+    size_t pos = csv.find('\n') + 1;
+    size_t i = first;
+    while (pos < csv.size()) {
+        unsigned long t;
+        unsigned track;
+        unsigned distance;
+        unsigned speed;
+        int angle;
+        TEST_ASSERT_EQUAL_INT(5, sscanf(csv.c_str() + pos, "%lu,%u,%u,%u,%d", &t, &track, &distance, &speed, &angle));
+        TEST_ASSERT_TRUE(i < frames.size());
+        TEST_ASSERT_EQUAL_UINT32(frames[i].t, t);
+        TEST_ASSERT_EQUAL_UINT32(frames[i].distance, distance);
+        TEST_ASSERT_EQUAL_UINT32(frames[i].speed, speed);
+        TEST_ASSERT_EQUAL_INT(frames[i].angle, angle);
+        pos = csv.find('\n', pos) + 1;
+        i++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(frames.size(), i);
+}
+
+void setUp() {
+    LittleFS.reset();
+    hostMillis = 1000;
+}
+
+void tearDown() {
+}
+
+void test_round_trip_across_segments() {
+    RideRecorder recorder;
+    recorder.begin();
+    const std::vector<Frame> frames = record(recorder, 3000, true);
+    drain(recorder);
+
+    TEST_ASSERT_TRUE(readIndex().size() > 2);
+    assertIndexPointsAtData();
+    assertCsvMatches(exportCsv(0, 0), frames, 0);
+
+    // 从中途开始导出：由索引定位起始段，只输出不早于 fromMs 的记录
+    const size_t mid = 2000;
+    assertCsvMatches(exportCsv(0, frames[mid].t), frames, mid);
+}
+
+void test_record_frame_never_touches_flash() {
+    RideRecorder recorder;
+    recorder.begin();
+    const size_t opens = LittleFS.openCount;
+    // 音频一直播放：loop 不落盘，缓冲满后丢帧，但不会在 recordFrame 中写文件
+    record(recorder, 2000, false);
+    TEST_ASSERT_EQUAL_UINT32(opens, LittleFS.openCount);
+    TEST_ASSERT_NULL(LittleFS.data(RIDE_INDEX_PATH));
+
+    // 空闲后由 loop 写出，段文件与索引同时出现
+    recorder.loop(true);
+    TEST_ASSERT_TRUE(LittleFS.openCount > opens);
+    TEST_ASSERT_EQUAL_UINT32(1, readIndex().size());
+    assertIndexPointsAtData();
+}
+
+void test_index_written_after_segment_data() {
+    RideRecorder recorder;
+    recorder.begin();
+    uint32_t t = hostMillis;
+    for (uint32_t i = 0; i < 5000; i++) {
+        const Frame f = makeFrame(i, t);
+        hostMillis = f.t;
+        recorder.recordFrame(f.distance, f.speed, f.angle);
+        // 每次落盘后索引中的每个段都已有数据，导出时不会遇到空段
+        recorder.loop(i % 7 != 0);
+        assertIndexPointsAtData();
+    }
+}
+
+void test_prune_oldest_segments_of_current_ride() {
+    // 上一次骑行很短，本次骑行很长：删完上一次后继续删除本次骑行最早的段
+    {
+        RideRecorder previous;
+        previous.begin();
+        record(previous, 100, true);
+        drain(previous);
+    }
+    RideRecorder recorder;
+    recorder.begin();
+    const std::vector<Frame> frames = record(recorder, 150000, true);
+    drain(recorder);
+
+    FSInfo info;
+    LittleFS.info(info);
+    TEST_ASSERT_TRUE(info.usedBytes <= RIDE_ARCHIVE_MAX_BYTES + RIDE_SEGMENT_SIZE);
+
+    const std::vector<RideSegmentInfo> index = readIndex();
+    TEST_ASSERT_TRUE(index.size() > 1);
+    for (const RideSegmentInfo &e : index) {
+        TEST_ASSERT_EQUAL_UINT16(1, e.ride);
+    }
+    TEST_ASSERT_TRUE(index.front().segment > 0);
+    assertIndexPointsAtData();
+
+    // 剩余的段仍可连续导出，最后一帧完整
+    const std::string csv = exportCsv(1, 0);
+    size_t first = 0;
+    while (frames[first].t < index.front().startMs) {
+        first++;
+    }
+    assertCsvMatches(csv, frames, first);
+}
+
+void test_report_encode_decode_cost() {
+    const uint32_t count = 20000;
+    std::vector<Frame> frames;
+    uint32_t t = hostMillis;
+    for (uint32_t i = 0; i < count; i++) {
+        frames.push_back(makeFrame(i, t));
+    }
+    RideRecorder recorder;
+    recorder.begin();
+    const auto encodeStart = std::chrono::steady_clock::now();
+    for (const Frame &f : frames) {
+        hostMillis = f.t;
+        recorder.recordFrame(f.distance, f.speed, f.angle);
+        recorder.loop(true);
+    }
+    drain(recorder);
+    const auto encodeEnd = std::chrono::steady_clock::now();
+
+    size_t bytes = 0;
+    char path[32];
+    for (const RideSegmentInfo &e : readIndex()) {
+        RideRecorder::segmentPath(path, sizeof(path), e.ride, e.segment);
+        bytes += LittleFS.data(path)->size();
+    }
+
+    const auto decodeStart = std::chrono::steady_clock::now();
+    const std::string csv = exportCsv(0, 0);
+    const auto decodeEnd = std::chrono::steady_clock::now();
+    assertCsvMatches(csv, frames, 0);
+
+    const double encodeNs = std::chrono::duration<double, std::nano>(encodeEnd - encodeStart).count() / count;
+    const double decodeNs = std::chrono::duration<double, std::nano>(decodeEnd - decodeStart).count() / count;
+    char msg[160];
+    // 主机耗时含内存文件系统写入，只作相对参考；每条记录字节数与平台无关
+    snprintf(msg, sizeof(msg), "主机：编码 %.0f ns/帧（含落盘），解码为 CSV %.0f ns/帧；平均 %.2f 字节/记录，CSV %.1f 字节/行",
+             encodeNs, decodeNs, (double) bytes / count, (double) csv.size() / count);
+    TEST_MESSAGE(msg);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_across_segments);
+    RUN_TEST(test_record_frame_never_touches_flash);
+    RUN_TEST(test_index_written_after_segment_data);
+    RUN_TEST(test_prune_oldest_segments_of_current_ride);
+    RUN_TEST(test_report_encode_decode_cost);
+    return UNITY_END();
+}
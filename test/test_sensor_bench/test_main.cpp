@@ -0,0 +1,127 @@
+// 多路雷达解析开销：报告 1/2/3 路同时满速输入时的每帧耗时（应基本不变，每轮总耗时随路数线性增长）
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include "RadarSensor.h"
+
+#define BENCH_FRAMES 200000             // 每路解析的帧数
+#define FRAME_TARGETS 3
+#define FRAMES_PER_POLL 2               // 每轮主循环每路读到的帧数
+
+// 循环输出同一帧字节的输入流，读取开销可忽略
+class FrameStream : public Stream {
+public:
+    uint8_t frame[64];
+    size_t frameLen = 0;
+    size_t pos = 0;
+    size_t remaining = 0;
+
+    int available() override {
+        return (int) remaining;
+    }
+
+    int read() override {
+        if (remaining == 0) {
+            return -1;
+        }
+        remaining--;
+        const uint8_t b = frame[pos];
+        pos = pos + 1 == frameLen ? 0 : pos + 1;
+        return b;
+    }
+
+    size_t write(uint8_t) override {
+        return 1;
+    }
+
+    void queueFrames(size_t count) {
+        remaining += count * frameLen;
+    }
+};
+
+// 帧头 + 长度 + 目标数 + 报警 + 每目标 5 字节 + 帧尾
+static size_t buildFrame(uint8_t *out) {
+    static const uint8_t header[] = {0xF4, 0xF3, 0xF2, 0xF1};
+    static const uint8_t footer[] = {0xF8, 0xF7, 0xF6, 0xF5};
+    size_t n = 0;
+    memcpy(out, header, 4);
+    n += 4;
+    const uint16_t len = 2 + FRAME_TARGETS * 5;
+    out[n++] = len & 0xFF;
+    out[n++] = len >> 8;
+    out[n++] = FRAME_TARGETS;
+    out[n++] = 0;
+    for (uint8_t i = 0; i < FRAME_TARGETS; i++) {
+        out[n++] = 0x80 + i * 3;        // 角度
+        out[n++] = 20 + i * 5;          // 距离
+        out[n++] = 0x01;                // 靠近
+        out[n++] = 30;                  // 速度
+        out[n++] = 0x40;                // 信噪比
+    }
+    memcpy(out + n, footer, 4);
+    return n + 4;
+}
+
+static RadarSensor sensors[3];
+static FrameStream streams[3];
+
+// 返回每帧平均耗时（纳秒）
+static double runBench(uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        sensors[i] = RadarSensor();
+        streams[i].frameLen = buildFrame(streams[i].frame);
+        streams[i].pos = 0;
+        streams[i].remaining = 0;
+        sensors[i].attach(i, &streams[i], (int8_t) (i * 30));
+    }
+    RadarTarget targets[RADAR_MAX_TARGETS * 3];
+    uint32_t decoded = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t pass = 0; pass < BENCH_FRAMES / FRAMES_PER_POLL; pass++) {
+        uint8_t fused = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            streams[i].queueFrames(FRAMES_PER_POLL);
+            uint8_t n;
+            if (sensors[i].poll(&targets[fused], n, pass)) {
+                fused += n;
+            }
+        }
+        decoded += fused;
+    }
+    const auto end = std::chrono::steady_clock::now();
+    for (uint8_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(BENCH_FRAMES, sensors[i].getCounters().frames);
+        TEST_ASSERT_EQUAL_UINT32(0, sensors[i].getCounters().badFrames);
+    }
+    TEST_ASSERT_EQUAL_UINT32((uint32_t) FRAME_TARGETS * count * (BENCH_FRAMES / FRAMES_PER_POLL), decoded);
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return ns / ((double) BENCH_FRAMES * count);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_report_per_frame_cost_by_sensor_count() {
+    double perFrame[4];
+    for (uint8_t count = 1; count <= 3; count++) {
+        perFrame[count] = runBench(count);
+        char msg[128];
+        snprintf(msg, sizeof(msg), "%u 路雷达：每帧 %.0f ns，每轮（每路 %u 帧）%.0f ns", (unsigned) count, perFrame[count],
+                 (unsigned) FRAMES_PER_POLL, perFrame[count] * FRAMES_PER_POLL * count);
+        TEST_MESSAGE(msg);
+    }
+    // 只报告耗时不做断言：墙钟计时在负载较高的主机上波动很大
+    char msg[96];
+    snprintf(msg, sizeof(msg), "2 路/1 路每帧耗时比 %.2f，3 路/1 路 %.2f", perFrame[2] / perFrame[1],
+             perFrame[3] / perFrame[1]);
+    TEST_MESSAGE(msg);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_report_per_frame_cost_by_sensor_count);
+    return UNITY_END();
+}
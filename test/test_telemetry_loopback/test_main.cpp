@@ -0,0 +1,229 @@
+// 遥测回环：TelemetryPacket 拼装的包经本机 UDP 发送、接收，再按 tools/telemetry_receiver.py 中
+// struct 格式串描述的布局逐字段解码，确认设备端与接收端格式一致；并报告本机回环延迟
+#include <Arduino.h>
+#include <unity.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <chrono>
+#include <regex>
+#include <string>
+#include <vector>
+#include "TelemetryPacket.h"
+
+struct ReceiverLayout {
+    std::string header;     // 如 "<HBBIIBBHHH"
+    std::string target;
+    long magic;
+    long version;
+};
+
+static bool readReceiverLayout(ReceiverLayout &layout) {
+    std::string path = __FILE__;
+    path = path.substr(0, path.rfind("test/test_telemetry_loopback")) + "tools/telemetry_receiver.py";
+    FILE *f = fopen(path.c_str(), "r");
+    if (f == nullptr) {
+        return false;
+    }
+    std::string text;
+    char chunk[256];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        text.append(chunk, n);
+    }
+    fclose(f);
+    std::smatch m;
+    if (!std::regex_search(text, m, std::regex("HEADER = struct\\.Struct\\('([^']+)'\\)"))) {
+        return false;
+    }
+    layout.header = m[1];
+    if (!std::regex_search(text, m, std::regex("TARGET = struct\\.Struct\\('([^']+)'\\)"))) {
+        return false;
+    }
+    layout.target = m[1];
+    if (!std::regex_search(text, m, std::regex("MAGIC = (0x[0-9A-Fa-f]+|\\d+)"))) {
+        return false;
+    }
+    layout.magic = strtol(m[1].str().c_str(), nullptr, 0);
+    if (!std::regex_search(text, m, std::regex("VERSION = (\\d+)"))) {
+        return false;
+    }
+    layout.version = strtol(m[1].str().c_str(), nullptr, 0);
+    return true;
+}
+
+// 按 Python struct 格式串（小端、无对齐，只含 B b H h I i）解码；返回消耗的字节数，格式不支持时返回 0
+static size_t unpack(const std::string &format, const uint8_t *data, size_t len, std::vector<long> &out) {
+    if (format.empty() || format[0] != '<') {
+        return 0;
+    }
+    size_t pos = 0;
+    for (size_t i = 1; i < format.size(); i++) {
+        const char c = format[i];
+        const size_t size = (c == 'B' || c == 'b') ? 1 : (c == 'H' || c == 'h') ? 2 : (c == 'I' || c == 'i') ? 4 : 0;
+        if (size == 0 || pos + size > len) {
+            return 0;
+        }
+        uint32_t v = 0;
+        for (size_t k = 0; k < size; k++) {
+            v |= (uint32_t) data[pos + k] << (8 * k);
+        }
+        long value = v;
+        if (c == 'b') {
+            value = (int8_t) v;
+        } else if (c == 'h') {
+            value = (int16_t) v;
+        } else if (c == 'i') {
+            value = (int32_t) v;
+        }
+        out.push_back(value);
+        pos += size;
+    }
+    return pos;
+}
+
+static RadarTarget makeTarget(uint8_t sensor, bool approaching, uint8_t distance, uint8_t speed, int8_t angle) {
+    RadarTarget t;
+    t.sensor = sensor;
+    t.approaching = approaching;
+    t.distance = distance;
+    t.speed = speed;
+    t.angle = angle;
+    t.timestamp = 0;
+    return t;
+}
+
+static int udpSocket(uint16_t &port) {
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (fd < 0 || bind(fd, (sockaddr *) &addr, sizeof(addr)) != 0) {
+        return -1;
+    }
+    socklen_t addrLen = sizeof(addr);
+    getsockname(fd, (sockaddr *) &addr, &addrLen);
+    port = ntohs(addr.sin_port);
+    timeval timeout = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+static ReceiverLayout layout;
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_layout_matches_receiver() {
+    TEST_ASSERT_TRUE(readReceiverLayout(layout));
+    TEST_ASSERT_EQUAL_INT(TELEMETRY_MAGIC, layout.magic);
+    TEST_ASSERT_EQUAL_INT(TELEMETRY_VERSION, layout.version);
+    const uint8_t zero[64] = {0};
+    std::vector<long> fields;
+    TEST_ASSERT_EQUAL_UINT32(sizeof(TelemetryHeader), unpack(layout.header, zero, sizeof(zero), fields));
+    fields.clear();
+    TEST_ASSERT_EQUAL_UINT32(sizeof(TelemetryTarget), unpack(layout.target, zero, sizeof(zero), fields));
+}
+
+void test_loopback_round_trip() {
+    TEST_ASSERT_TRUE(readReceiverLayout(layout));
+    uint16_t port;
+    const int rx = udpSocket(port);
+    uint16_t unused;
+    const int tx = udpSocket(unused);
+    TEST_ASSERT_TRUE(rx >= 0 && tx >= 0);
+    sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    dest.sin_port = htons(port);
+
+    TelemetryPacket packet;
+    const RadarTarget targets[3] = {makeTarget(0, true, 42, 18, -35), makeTarget(1, false, 7, 3, 0),
+                                    makeTarget(2, true, 120, 90, 44)};
+    const uint32_t rounds = 200;
+    double totalUs = 0;
+    double maxUs = 0;
+    for (uint32_t round = 0; round < rounds; round++) {
+        // 两包之间 3 轮主循环
+        packet.addLoop(900);
+        packet.addLoop(1100);
+        packet.addLoop(70000);
+        const uint8_t count = (uint8_t) (round % 4);
+        const uint8_t alert = TELEMETRY_ALERT_LEFT | (round & 1 ? TELEMETRY_ALERT_DANGER : 0);
+        const auto start = std::chrono::steady_clock::now();
+        const size_t len = packet.build(123456 + round * 100, targets, count, 0x05, alert);
+        TEST_ASSERT_EQUAL_INT((long) len, sendto(tx, packet.bytes(), len, 0, (sockaddr *) &dest, sizeof(dest)));
+        uint8_t buf[512];
+        const ssize_t got = recv(rx, buf, sizeof(buf), 0);
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        totalUs += us;
+        maxUs = us > maxUs ? us : maxUs;
+        TEST_ASSERT_EQUAL_INT((long) len, got);
+
+        // 与 telemetry_receiver.parse 相同的字段顺序
+        std::vector<long> h;
+        const size_t headerSize = unpack(layout.header, buf, got, h);
+        TEST_ASSERT_TRUE(headerSize > 0);
+        TEST_ASSERT_EQUAL_UINT32(10, h.size());
+        TEST_ASSERT_EQUAL_INT(layout.magic, h[0]);
+        TEST_ASSERT_EQUAL_INT(layout.version, h[1]);
+        TEST_ASSERT_EQUAL_INT(count, h[2]);
+        TEST_ASSERT_EQUAL_INT(round, h[3]);
+        TEST_ASSERT_EQUAL_INT(123456 + round * 100, h[4]);
+        TEST_ASSERT_EQUAL_INT(alert, h[5]);
+        TEST_ASSERT_EQUAL_INT(0x05, h[6]);
+        TEST_ASSERT_EQUAL_INT(3, h[7]);
+        TEST_ASSERT_EQUAL_INT(24000, h[8]);
+        TEST_ASSERT_EQUAL_INT(65535, h[9]);
+        size_t pos = headerSize;
+        for (uint8_t i = 0; i < count; i++) {
+            std::vector<long> t;
+            const size_t n = unpack(layout.target, buf + pos, got - pos, t);
+            TEST_ASSERT_TRUE(n > 0);
+            pos += n;
+            TEST_ASSERT_EQUAL_INT(targets[i].sensor, t[0]);
+            TEST_ASSERT_EQUAL_INT(targets[i].approaching ? 1 : 0, t[1]);
+            TEST_ASSERT_EQUAL_INT(targets[i].distance, t[2]);
+            TEST_ASSERT_EQUAL_INT(targets[i].speed, t[3]);
+            TEST_ASSERT_EQUAL_INT(targets[i].angle, t[4]);
+        }
+        TEST_ASSERT_EQUAL_INT(got, (long) pos);
+    }
+    close(rx);
+    close(tx);
+
+    char msg[128];
+    // 只报告不断言：本机回环不含 WiFi 空口与设备端调度，远小于实际链路延迟
+    snprintf(msg, sizeof(msg), "主机回环：拼装 + 发送 + 接收平均 %.1f us，最大 %.1f us（%lu 包）", totalUs / rounds, maxUs,
+             (unsigned long) rounds);
+    TEST_MESSAGE(msg);
+}
+
+void test_targets_truncated_to_packet() {
+    TelemetryPacket packet;
+    RadarTarget many[TELEMETRY_MAX_TARGETS + 5];
+    for (uint8_t i = 0; i < TELEMETRY_MAX_TARGETS + 5; i++) {
+        many[i] = makeTarget(i % 3, true, i, i, (int8_t) -i);
+    }
+    const size_t len = packet.build(0, many, TELEMETRY_MAX_TARGETS + 5, 0x07, 0);
+    TEST_ASSERT_EQUAL_UINT32(TELEMETRY_PACKET_MAX, len);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_MAX_TARGETS, ((const TelemetryHeader *) packet.bytes())->targetCount);
+    // 无循环统计时平均值为 0，不除零
+    TEST_ASSERT_EQUAL_UINT32(0, ((const TelemetryHeader *) packet.bytes())->loopAvgUs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_layout_matches_receiver);
+    RUN_TEST(test_loopback_round_trip);
+    RUN_TEST(test_targets_truncated_to_packet);
+    return UNITY_END();
+}
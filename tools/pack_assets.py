@@ -0,0 +1,113 @@
+"""把网页与内置音效打包为只读资源镜像，编译进固件的闪存区。
+
+作为 PlatformIO 的 pre 脚本运行时，按当前环境的功能开关选择资源，
+在构建目录生成 AssetBlob.h 并定义 RADAR_ASSET_BLOB；镜像格式见 src/AssetStore.h。
+也可单独运行查看打包结果：
+
+    python tools/pack_assets.py [输出文件]
+"""
+import os
+import struct
+import sys
+
+MAGIC = 0x31424152  # "RAB1"
+NAME_LEN = 16
+ENTRY_FORMAT = "<%dsII" % NAME_LEN
+ASSET_MAX = 8
+ALIGN = 4
+
+WEB_ASSETS = ["index.html", "favicon.ico"]
+AUDIO_ASSETS = ["normal.mp3", "danger.mp3", "left.mp3", "right.mp3", "rear.mp3", "start.mp3"]
+
+
+def pad(data):
+    return data + b"\0" * (-len(data) % ALIGN)
+
+
+def pack(src_dir, names):
+    """返回 (镜像字节, [(路径, 偏移, 大小)])，缺失的文件跳过。"""
+    files = []
+    for name in names:
+        path = os.path.join(src_dir, name)
+        if os.path.isfile(path):
+            with open(path, "rb") as f:
+                files.append(("/" + name, f.read()))
+    if len(files) > ASSET_MAX:
+        raise SystemExit("内置资源最多 %d 个" % ASSET_MAX)
+    offset = 8 + len(files) * struct.calcsize(ENTRY_FORMAT)
+    index = []
+    body = b""
+    for name, data in files:
+        if len(name.encode()) >= NAME_LEN:
+            raise SystemExit("资源路径过长: " + name)
+        index.append((name, offset, len(data)))
+        body += pad(data)
+        offset += len(pad(data))
+    blob = struct.pack("<II", MAGIC, len(files))
+    for name, off, size in index:
+        blob += struct.pack(ENTRY_FORMAT, name.encode(), off, size)
+    return blob + body, index
+
+
+def render_header(blob, index):
+    lines = [
+        "// 由 tools/pack_assets.py 生成，请勿手工修改",
+        "#pragma once",
+        "",
+    ]
+    for name, off, size in index:
+        lines.append("// %-14s offset=%-7d size=%d" % (name, off, size))
+    lines.append("#define ASSET_BLOB_SIZE %dUL" % len(blob))
+    lines.append("static const uint8_t ASSET_BLOB[] PROGMEM __attribute__((aligned(4))) = {")
+    for i in range(0, len(blob), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in blob[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines) + "\n"
+
+
+def write_if_changed(path, text):
+    # 内容不变时不改写，避免每次构建都重新编译 AssetStore.cpp
+    if os.path.isfile(path):
+        with open(path, "r", encoding="utf-8") as f:
+            if f.read() == text:
+                return
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, "w", encoding="utf-8") as f:
+        f.write(text)
+
+
+def feature_enabled(env, name):
+    flags = env.ParseFlags(env.get("BUILD_FLAGS", []))
+    for define in flags.get("CPPDEFINES", []):
+        if isinstance(define, (list, tuple)) and define[0] == name:
+            return str(define[1]) != "0"
+    return True
+
+
+def run_pio(env):
+    names = []
+    if feature_enabled(env, "RADAR_FEATURE_WEB"):
+        names += WEB_ASSETS
+    if feature_enabled(env, "RADAR_FEATURE_AUDIO"):
+        names += AUDIO_ASSETS
+    if not names:
+        return
+    blob, index = pack(os.path.join(env["PROJECT_DIR"], "assets"), names)
+    out_dir = os.path.join(env.subst("$BUILD_DIR"), "assets")
+    write_if_changed(os.path.join(out_dir, "AssetBlob.h"), render_header(blob, index))
+    env.Append(CPPPATH=[out_dir], CPPDEFINES=[("RADAR_ASSET_BLOB", 1)])
+    print("内置资源 %d 个，共 %d 字节" % (len(index), len(blob)))
+
+
+try:
+    Import("env")  # noqa: F821  PlatformIO 注入
+    run_pio(env)  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+        blob, index = pack(os.path.join(root, "assets"), WEB_ASSETS + AUDIO_ASSETS)
+        for name, off, size in index:
+            print("%-14s offset=%-7d size=%d" % (name, off, size))
+        print("total %d bytes" % len(blob))
+        if len(sys.argv) > 1:
+            write_if_changed(sys.argv[1], render_header(blob, index))
@@ -0,0 +1,12 @@
+#!/bin/sh
+# 依次编译各编译配置并汇总固件的 Flash/RAM 占用。
+# 每帧周期数需在设备上读取：完整配置访问 /profile；无网页的配置以
+#   PLATFORMIO_BUILD_FLAGS=-DRADAR_CYCLE_REPORT_MS=5000 pio run -e light -t upload
+# 烧录后从串口读取。
+set -e
+cd "$(dirname "$0")/.."
+ENVS="${*:-light audio nodemcuv2}"
+for env in $ENVS; do
+    echo "== $env"
+    pio run -e "$env" | grep -E '^(RAM|Flash):'
+done
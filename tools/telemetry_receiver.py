@@ -0,0 +1,47 @@
+#!/usr/bin/env python3
+"""接收雷达 UDP 遥测并逐包打印，格式见 src/TelemetryPacket.h。
+
+用法：python3 tools/telemetry_receiver.py [端口]   （默认 4210）
+"""
+import socket
+import struct
+import sys
+
+HEADER = struct.Struct('<HBBIIBBHHH')
+TARGET = struct.Struct('<BBBBb')
+MAGIC = 0x5452
+VERSION = 1
+
+
+def parse(packet):
+    if len(packet) < HEADER.size:
+        return None
+    magic, version, count, seq, time_ms, alert, sensors, loops, loop_avg, loop_max = HEADER.unpack_from(packet)
+    if magic != MAGIC or version != VERSION or len(packet) < HEADER.size + count * TARGET.size:
+        return None
+    targets = [TARGET.unpack_from(packet, HEADER.size + i * TARGET.size) for i in range(count)]
+    return seq, time_ms, alert, sensors, loops, loop_avg, loop_max, targets
+
+
+def main():
+    port = int(sys.argv[1]) if len(sys.argv) > 1 else 4210
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(('', port))
+    last_seq = None
+    while True:
+        packet, addr = sock.recvfrom(512)
+        parsed = parse(packet)
+        if parsed is None:
+            continue
+        seq, time_ms, alert, sensors, loops, loop_avg, loop_max, targets = parsed
+        lost = seq - last_seq - 1 if last_seq is not None and seq > last_seq else 0
+        last_seq = seq
+        flags = ''.join(c if alert & bit else '-' for c, bit in (('L', 1), ('R', 2), ('D', 4), ('A', 8)))
+        items = ' '.join(f'[s{s} {d}m {v}km/h {a:+d}°{"" if ap else " 远离"}]' for s, ap, d, v, a in targets)
+        print(f'#{seq} t={time_ms} {flags} sensors={sensors:#04x} loop={loops}x avg {loop_avg}us max {loop_max}us'
+              f'{f" 丢包 {lost}" if lost else ""} {items}')
+
+
+if __name__ == '__main__':
+    main()